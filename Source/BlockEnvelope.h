@@ -0,0 +1,434 @@
+/*
+  ==============================================================================
+
+    BlockEnvelope.h
+    Created: 18 Oct 2026 5:03:52am
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+
+/** An ADSR envelope that renders a whole block at a time.
+
+    Follows the same stages as juce::ADSR, but instead of stepping one sample at a time, works out analytically
+    how many samples are left in the current stage and renders them in one go. Within a stage every sample is
+    a closed form or a four-wide recurrence of the stage's start, so the loops vectorise and never test where
+    the stage ends.
+
+    Attacks are always linear. Decays and releases can be linear, as juce::ADSR's are, or exponential: a
+    one-pole curve aimed just beyond the stage's end, so it still arrives in the set time.
+
+    Holds no pointers or buffers, so envelopes can be stored and swapped by value.
+*/
+class BlockEnvelope
+{
+public:
+    enum class Curve
+    {
+        linear,
+        exponential
+    };
+
+    /** Times in seconds, and the sustain level from 0 to 1.
+
+    */
+    struct Parameters
+    {
+        float attack = 0.1f;
+        float decay = 0.1f;
+        float sustain = 1.0f;
+        float release = 0.1f;
+
+        Curve curve = Curve::linear;
+    };
+
+    BlockEnvelope() = default;
+
+    //==============================================================================
+    void setSampleRate(double newSampleRate) noexcept
+    {
+        jassert(newSampleRate > 0.0);
+
+        sampleRate = newSampleRate;
+        updateRates();
+    }
+
+    /** Sets new parameters. A stage in progress carries on from its current level at the new rate.
+
+    */
+    void setParameters(const Parameters& newParameters) noexcept
+    {
+        parameters = newParameters;
+        updateRates();
+    }
+
+    const Parameters& getParameters() const noexcept
+    {
+        return parameters;
+    }
+
+    /** Returns true unless the envelope has finished its release, or was never started.
+
+    */
+    bool isActive() const noexcept
+    {
+        return stage != Stage::idle;
+    }
+
+    /** Returns true during the attack. At any other stage the envelope can only hold or fall until the next noteOn.
+
+    */
+    bool isInAttack() const noexcept
+    {
+        return stage == Stage::attack;
+    }
+
+    /** Returns the level of the last sample rendered, before any gain.
+
+    */
+    float getLevel() const noexcept
+    {
+        return level;
+    }
+
+    //==============================================================================
+    /** Starts the attack from the current level, or skips to the first stage with a time.
+
+    */
+    void noteOn() noexcept
+    {
+        if (attackStep > 0.0f)
+        {
+            stage = Stage::attack;
+        }
+        else if (hasDecay())
+        {
+            level = 1.0f;
+            startDecay();
+        }
+        else
+        {
+            stage = Stage::sustain;
+        }
+    }
+
+    /** Starts the release from the current level, which takes the release time however high that is.
+
+    */
+    void noteOff() noexcept
+    {
+        if (stage == Stage::idle)
+        {
+            return;
+        }
+
+        if (parameters.release <= 0.0f || level <= 0.0f)
+        {
+            reset();
+            return;
+        }
+
+        float numReleaseSamples = (float)(parameters.release * sampleRate);
+
+        if (parameters.curve == Curve::exponential)
+        {
+            startCurve(-exponentialOvershoot * (double)level, 0.0f, numReleaseSamples);
+        }
+        else
+        {
+            startRamp(-level / numReleaseSamples);
+        }
+
+        stage = Stage::release;
+    }
+
+    void reset() noexcept
+    {
+        level = 0.0f;
+        stage = Stage::idle;
+    }
+
+    //==============================================================================
+    /** Writes the next numSamples of the envelope into dest, scaled by gain, and advances it.
+
+    */
+    void renderBlock(float* dest, int numSamples, float gain) noexcept
+    {
+        while (numSamples > 0)
+        {
+            if (stage == Stage::idle || stage == Stage::sustain)
+            {
+                level = stage == Stage::idle ? 0.0f : parameters.sustain;
+                FloatVectorOperations::fill(dest, level * gain, numSamples);
+                return;
+            }
+
+            bool exponential = stage != Stage::attack && curveInProgress;
+            float end = getStageEnd();
+
+            // Samples until the stage reaches its end, the last of which lands exactly on it
+            int remaining = exponential ? curveSamplesRemaining : getRampSamplesTo(end);
+            int numThisTime = jmin(numSamples, remaining);
+
+            if (exponential)
+            {
+                renderCurve(dest, numThisTime, gain);
+                curveSamplesRemaining -= numThisTime;
+            }
+            else
+            {
+                renderRamp(dest, numThisTime, gain);
+            }
+
+            if (numThisTime == remaining)
+            {
+                level = end;
+                dest[numThisTime - 1] = end * gain;
+                finishStage();
+            }
+
+            dest += numThisTime;
+            numSamples -= numThisTime;
+        }
+    }
+
+private:
+    enum class Stage
+    {
+        idle,
+        attack,
+        decay,
+        sustain,
+        release
+    };
+
+    // How far beyond their end exponential stages aim, as a fraction of their distance: about -80 dB
+    static constexpr float exponentialOvershoot = 1.0e-4f;
+
+    Parameters parameters;
+    double sampleRate = 44100.0;
+
+    Stage stage = Stage::idle;
+    float level = 0.0f;
+
+    // Level per sample of the attack, or 0 if there isn't one
+    float attackStep = 0.0f;
+
+    // The linear stage in progress moves by segmentStep a sample. An exponential one is curveTarget plus an offset
+    // shrinking by curveCoefficient a sample
+    float segmentStep = 0.0f;
+    float curveTarget = 0.0f;
+    float curveCoefficient = 0.0f;
+
+    // Whether the decay or release in progress is exponential, fixed when it starts, and if so how many samples it
+    // has left. The count is worked out once in double precision, so where the stage ends doesn't depend on how
+    // it was split into blocks
+    bool curveInProgress = false;
+    int curveSamplesRemaining = 0;
+
+    //==============================================================================
+    bool hasDecay() const noexcept
+    {
+        return parameters.decay > 0.0f && parameters.sustain < 1.0f;
+    }
+
+    void updateRates() noexcept
+    {
+        attackStep = parameters.attack > 0.0f ? (float)(1.0 / (parameters.attack * sampleRate)) : 0.0f;
+
+        if (stage == Stage::decay)
+        {
+            // A sustain raised to or above the level ends the decay, and the envelope steps up to it as juce::ADSR does
+            if (level <= parameters.sustain)
+            {
+                stage = Stage::sustain;
+            }
+            else
+            {
+                startDecay();
+            }
+        }
+    }
+
+    void startDecay() noexcept
+    {
+        if (!hasDecay())
+        {
+            stage = Stage::sustain;
+            return;
+        }
+
+        float numDecaySamples = (float)(parameters.decay * sampleRate);
+        float range = 1.0f - parameters.sustain;
+
+        if (parameters.curve == Curve::exponential)
+        {
+            startCurve((double)parameters.sustain - exponentialOvershoot * (double)range, parameters.sustain, numDecaySamples);
+        }
+        else
+        {
+            startRamp(-range / numDecaySamples);
+        }
+
+        stage = Stage::decay;
+    }
+
+    void startRamp(float step) noexcept
+    {
+        segmentStep = step;
+        curveInProgress = false;
+    }
+
+    /** Aims a one-pole curve at target, at a rate that takes numStageSamples to cover all but the overshoot of the
+        distance, and counts the samples it takes from the current level to end.
+    */
+    void startCurve(double target, float end, float numStageSamples) noexcept
+    {
+        double logCoefficient = -std::log((1.0 + exponentialOvershoot) / exponentialOvershoot) / jmax(1.0, (double)numStageSamples);
+
+        curveTarget = (float)target;
+        curveCoefficient = (float)std::exp(logCoefficient);
+        curveSamplesRemaining = getCurveSamplesTo(target, end, logCoefficient);
+        curveInProgress = true;
+    }
+
+    float getStageEnd() const noexcept
+    {
+        switch (stage)
+        {
+            case Stage::attack:     return 1.0f;
+            case Stage::decay:      return parameters.sustain;
+            case Stage::release:
+            case Stage::idle:
+            case Stage::sustain:
+            default:                return 0.0f;
+        }
+    }
+
+    void finishStage() noexcept
+    {
+        if (stage == Stage::attack)
+        {
+            startDecay();
+        }
+        else if (stage == Stage::decay)
+        {
+            stage = Stage::sustain;
+        }
+        else
+        {
+            reset();
+        }
+    }
+
+    // ===========================
+    // ====== STAGE LENGTHS ======
+    // ===========================
+    /** Samples for the linear stage in progress to reach or pass end, at least 1.
+
+    */
+    int getRampSamplesTo(float end) const noexcept
+    {
+        float step = stage == Stage::attack ? attackStep : segmentStep;
+        double samples = std::ceil(((double)end - (double)level) / (double)step);
+
+        return toSampleCount(samples);
+    }
+
+    /** Samples for a curve from the current level towards target to reach or pass end, at least 1.
+
+    */
+    int getCurveSamplesTo(double target, float end, double logCoefficient) const noexcept
+    {
+        double offset = (double)level - target;
+        double endOffset = (double)end - target;
+
+        double ratio = endOffset / offset;
+
+        // Already at or past end, or behind the target so the curve would never reach it: the next sample lands on it
+        if (offset == 0.0 || !(ratio > 0.0 && ratio < 1.0))
+        {
+            return 1;
+        }
+
+        // Within a millionth of a whole count rounds down to it, so a stage of a whole number of samples takes exactly that
+        double samples = std::ceil(std::log(ratio) / logCoefficient - 1.0e-6);
+
+        return toSampleCount(samples);
+    }
+
+    /** Clamps a sample count to at least 1, treating anything non-finite as 1 rather than casting it.
+
+    */
+    static int toSampleCount(double samples) noexcept
+    {
+        if (!std::isfinite(samples))
+        {
+            return 1;
+        }
+
+        return (int)jlimit(1.0, (double)std::numeric_limits<int>::max(), samples);
+    }
+
+    // =============================
+    // ====== STAGE RENDERING ======
+    // =============================
+    /** Renders numSamples of the linear stage in progress, each from the stage's start rather than the sample before.
+
+    */
+    void renderRamp(float* dest, int numSamples, float gain) noexcept
+    {
+        float step = stage == Stage::attack ? attackStep : segmentStep;
+        float start = level * gain;
+        float gainedStep = step * gain;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            dest[i] = start + gainedStep * (float)(i + 1);
+        }
+
+        level += step * (float)numSamples;
+    }
+
+    /** Renders numSamples of the exponential stage in progress.
+
+        Four consecutive offsets are kept and each is advanced by the coefficient to the fourth, so the
+        four are independent and the loop vectorises like a linear one.
+    */
+    void renderCurve(float* dest, int numSamples, float gain) noexcept
+    {
+        float target = curveTarget * gain;
+        float coefficient4 = curveCoefficient * curveCoefficient * curveCoefficient * curveCoefficient;
+
+        float offsets[4];
+        offsets[0] = (level - curveTarget) * gain * curveCoefficient;
+
+        for (int k = 1; k < 4; ++k)
+        {
+            offsets[k] = offsets[k - 1] * curveCoefficient;
+        }
+
+        int i = 0;
+
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            for (int k = 0; k < 4; ++k)
+            {
+                dest[i + k] = target + offsets[k];
+                offsets[k] *= coefficient4;
+            }
+        }
+
+        for (int k = 0; i < numSamples; ++i, ++k)
+        {
+            dest[i] = target + offsets[k];
+        }
+
+        level = curveTarget + (level - curveTarget) * (float)std::pow((double)curveCoefficient, (double)numSamples);
+    }
+};
@@ -23,9 +23,18 @@ namespace IDs
 
     Identifier OSC_MGR("OscillatorManager");
         Identifier voiceStealMode("VoiceStealMode");
+        Identifier voiceStealPolicy("VoiceStealPolicy");
+        Identifier interpolation("Interpolation");
+        Identifier pitchBendRange("PitchBendRange");
+        Identifier silenceFloor("SilenceFloor");
+        Identifier silenceTime("SilenceTime");
+        Identifier renderMode("RenderMode");
+        Identifier renderThreads("RenderThreads");
         Identifier OSC_GROUP("OscillatorGroup");
             Identifier OSC("Oscillator");
                 Identifier waveType("WaveType");
+                Identifier pan("Pan");
+                Identifier framePosition("Position");
                 Identifier DETUNE("Detune");
                     Identifier detuneOctave("Octave");
                     Identifier detuneCoarse("Coarse");
@@ -36,7 +45,17 @@ namespace IDs
             Identifier decay("Decay");
             Identifier sustain("Sustain");
             Identifier release("Release");
+            Identifier curve("Curve");
 
     Identifier polyphony("Polyphony");
 
+    // =======================
+    // ====== WAVEFORMS ======
+    // =======================
+    Identifier SINE("SINE");
+    Identifier SAW("SAW");
+    Identifier RAMP("RAMP");
+    Identifier TRIANGLE("TRIANGLE");
+    Identifier SQUARE("SQUARE");
+
 }
\ No newline at end of file
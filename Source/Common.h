@@ -12,6 +12,13 @@
 
 #include <JuceHeader.h>
 
+/** Set to 1 for WavetableOscillator to use a 32-bit fixed-point phase accumulator (see PhaseAccumulator.h),
+    or 0 for the original float index. Can be overridden in the Projucer's preprocessor definitions.
+*/
+#ifndef SYNTHFRAMEWORK_FIXED_POINT_PHASE
+ #define SYNTHFRAMEWORK_FIXED_POINT_PHASE 1
+#endif
+
 /** A namespace containing juce:Identifier objects for use with reading/writing the value tree.
 
 */
@@ -28,9 +35,27 @@ namespace IDs
     // Default tree structure
     extern Identifier OSC_MGR;
         extern Identifier voiceStealMode;
+        // OLDEST, QUIETEST or PROTECT_LOWEST
+        extern Identifier voiceStealPolicy;
+        // NEAREST, LINEAR, HERMITE or SINC
+        extern Identifier interpolation;
+        // Semitones of pitch bend at full deflection of the wheel
+        extern Identifier pitchBendRange;
+        // dBFS below which a falling note counts as silent, and the seconds it must stay there before its voice is retired.
+        // 0 seconds never retires a voice early
+        extern Identifier silenceFloor;
+        extern Identifier silenceTime;
+        // AUTO, SERIAL, INTERLEAVED or PARALLEL, applied when playback is prepared. AUTO renders in parallel only when bouncing offline
+        extern Identifier renderMode;
+        // Worker threads for parallel rendering, besides the audio thread. -1 uses every core but one
+        extern Identifier renderThreads;
         extern Identifier OSC_GROUP;
             extern Identifier OSC;
                 extern Identifier waveType;
+                // -1 (left) to 1 (right)
+                extern Identifier pan;
+                // 0 (first frame) to 1 (last frame)
+                extern Identifier framePosition;
                 extern Identifier DETUNE;
                     extern Identifier detuneOctave;
                     extern Identifier detuneCoarse;
@@ -42,8 +67,20 @@ namespace IDs
             extern Identifier decay;
             extern Identifier sustain;
             extern Identifier release;
+            // LINEAR or EXPONENTIAL decay and release
+            extern Identifier curve;
 
     extern Identifier polyphony;
+
+    // =======================
+    // ====== WAVEFORMS ======
+    // =======================
+    // Keys of the base wavetables in the WavetableRegistry. Each matches the waveType value that selects it
+    extern Identifier SINE;
+    extern Identifier SAW;
+    extern Identifier RAMP;
+    extern Identifier TRIANGLE;
+    extern Identifier SQUARE;
 }
 
 
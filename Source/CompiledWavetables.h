@@ -0,0 +1,343 @@
+/*
+  ==============================================================================
+
+    CompiledWavetables.h
+    Created: 18 Oct 2026 1:48:31am
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MipmappedWavetable.h"
+#include "WavetableCreator.h"
+
+
+/** Where each level of a compiled chain of tableSize sits: the same levels WavetableCreator adds at runtime.
+
+*/
+template <int tableSize>
+struct CompiledChainLayout
+{
+    static_assert(isPowerOfTwo(tableSize) && tableSize >= WavetableCreator::minimumLevelSize * 2, "Compiled tables need a power of two size");
+
+    static constexpr int getNumLevels() noexcept
+    {
+        int numLevels = 1;
+
+        for (int harmonics = tableSize / WavetableCreator::samplesPerHarmonic; harmonics > 1; harmonics /= 2)
+        {
+            ++numLevels;
+        }
+
+        return numLevels;
+    }
+
+    static constexpr int getLevelSize(int level) noexcept
+    {
+        return jmax(WavetableCreator::minimumLevelSize, tableSize >> level);
+    }
+
+    static constexpr int getLevelHarmonics(int level) noexcept
+    {
+        return jmax(1, (tableSize / WavetableCreator::samplesPerHarmonic) >> level);
+    }
+
+    /** Returns the index where level starts, guard samples included. Each level takes a whole number of cache lines, so every one starts on a line.
+
+    */
+    static constexpr int getLevelOffset(int level) noexcept
+    {
+        int offset = 0;
+
+        for (int i = 0; i < level; ++i)
+        {
+            offset += MipmappedWavetable::getFrameStrideForSize(getLevelSize(i));
+        }
+
+        return offset;
+    }
+
+    static constexpr int getNumSamples() noexcept
+    {
+        return getLevelOffset(getNumLevels());
+    }
+};
+
+//==================================================================================
+/** The mip chain of one base shape at one table size, generated entirely at compile time.
+
+    Every level is band-limited as WavetableCreator does at runtime: the harmonic sum is evaluated with a constexpr
+    inverse FFT in double precision, then normalised by the peak of level 0 and rounded to float.
+*/
+template <int tableSize>
+struct CompiledChain
+{
+    using Layout = CompiledChainLayout<tableSize>;
+
+    alignas(64) std::array<float, (size_t)Layout::getNumSamples()> samples {};
+
+    // =====================================
+    // ====== COMPILE-TIME GENERATION ======
+    // =====================================
+    /** Generates the chain for shape. Only ever evaluated by the compiler.
+
+    */
+    static constexpr CompiledChain generate(WavetableCreator::BaseShape shape)
+    {
+        CompiledChain chain {};
+
+        // Interleaved complex samples of the largest level, reused by every level
+        std::array<double, (size_t)tableSize * 2> bins {};
+        double gain = 1.0;
+
+        for (int level = 0; level < Layout::getNumLevels(); ++level)
+        {
+            int levelSize = Layout::getLevelSize(level);
+
+            for (int i = 0; i < levelSize * 2; ++i)
+            {
+                bins[(size_t)i] = 0.0;
+            }
+
+            // Harmonic h of amplitude a is a * e^(ihx), whose imaginary part is a * sin(hx)
+            for (int harmonic = 1; harmonic <= Layout::getLevelHarmonics(level); ++harmonic)
+            {
+                bins[(size_t)harmonic * 2] = (double)WavetableCreator::getBaseShapeAmplitude(shape, harmonic);
+            }
+
+            inverseTransform(bins, levelSize);
+
+            // Every level is normalised by the peak of level 0, so the chain has a peak of 1 without level jumps
+            if (level == 0)
+            {
+                double peak = 0.0;
+
+                for (int i = 0; i < levelSize; ++i)
+                {
+                    peak = jmax(peak, absolute(bins[(size_t)i * 2 + 1]));
+                }
+
+                gain = peak > 0.0 ? 1.0 / peak : 1.0;
+            }
+
+            // The first sample comes after the frame's guard samples
+            int first = Layout::getLevelOffset(level) + MipmappedWavetable::guardSamplesBefore;
+
+            for (int i = 0; i < levelSize; ++i)
+            {
+                chain.samples[(size_t)(first + i)] = (float)(bins[(size_t)i * 2 + 1] * gain);
+            }
+
+            // Guard samples, as MipmappedWavetable::fillGuardSamples writes them
+            for (int i = 1; i <= MipmappedWavetable::guardSamplesBefore; ++i)
+            {
+                chain.samples[(size_t)(first - i)] = chain.samples[(size_t)(first + levelSize - i)];
+            }
+
+            for (int i = 0; i < MipmappedWavetable::guardSamplesAfter; ++i)
+            {
+                chain.samples[(size_t)(first + levelSize + i)] = chain.samples[(size_t)(first + i)];
+            }
+        }
+
+        return chain;
+    }
+
+private:
+    static constexpr double pi = 3.141592653589793238;
+
+    static constexpr double absolute(double x) noexcept
+    {
+        return x < 0.0 ? -x : x;
+    }
+
+    /** sin(x) for x in -pi..pi, from its Taylor polynomial once folded into -pi/2..pi/2, where it converges to double precision.
+
+    */
+    static constexpr double sine(double x) noexcept
+    {
+        if (x > pi * 0.5)
+        {
+            x = pi - x;
+        }
+        else if (x < -pi * 0.5)
+        {
+            x = -pi - x;
+        }
+
+        double term = x;
+        double sum = x;
+
+        for (int n = 1; n <= 12; ++n)
+        {
+            term *= -x * x / (double)((2 * n) * (2 * n + 1));
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    static constexpr double cosine(double x) noexcept
+    {
+        return sine(x > 0.0 ? pi * 0.5 - x : pi * 0.5 + x);
+    }
+
+    /** An unscaled, in-place, radix-2 inverse FFT of size interleaved complex values.
+
+        Each stage steps its twiddle by complex multiplication, so only two sines are evaluated per stage,
+        keeping the whole chain inside the compilers' constant evaluation limits.
+    */
+    static constexpr void inverseTransform(std::array<double, (size_t)tableSize * 2>& data, int size) noexcept
+    {
+        // Bit-reversed reordering
+        for (int i = 1, j = 0; i < size; ++i)
+        {
+            int bit = size >> 1;
+
+            for (; (j & bit) != 0; bit >>= 1)
+            {
+                j ^= bit;
+            }
+
+            j ^= bit;
+
+            if (i < j)
+            {
+                double real = data[(size_t)i * 2];
+                double imag = data[(size_t)i * 2 + 1];
+                data[(size_t)i * 2] = data[(size_t)j * 2];
+                data[(size_t)i * 2 + 1] = data[(size_t)j * 2 + 1];
+                data[(size_t)j * 2] = real;
+                data[(size_t)j * 2 + 1] = imag;
+            }
+        }
+
+        for (int length = 2; length <= size; length *= 2)
+        {
+            double angle = 2.0 * pi / (double)length;
+            double stepReal = cosine(angle);
+            double stepImag = sine(angle);
+
+            for (int start = 0; start < size; start += length)
+            {
+                double twiddleReal = 1.0;
+                double twiddleImag = 0.0;
+
+                for (int k = 0; k < length / 2; ++k)
+                {
+                    size_t even = (size_t)(start + k) * 2;
+                    size_t odd = (size_t)(start + k + length / 2) * 2;
+
+                    double oddReal = data[odd] * twiddleReal - data[odd + 1] * twiddleImag;
+                    double oddImag = data[odd] * twiddleImag + data[odd + 1] * twiddleReal;
+
+                    data[odd] = data[even] - oddReal;
+                    data[odd + 1] = data[even + 1] - oddImag;
+                    data[even] += oddReal;
+                    data[even + 1] += oddImag;
+
+                    double nextReal = twiddleReal * stepReal - twiddleImag * stepImag;
+                    twiddleImag = twiddleReal * stepImag + twiddleImag * stepReal;
+                    twiddleReal = nextReal;
+                }
+            }
+        }
+    }
+};
+
+/** The compiled chain of each base shape at each compiled size.
+
+    inline, so there's one copy in the plugin's read-only data however many files use it, which every instance
+    and every process loading the plugin shares through the same pages of the binary.
+*/
+template <int tableSize, WavetableCreator::BaseShape shape>
+inline constexpr CompiledChain<tableSize> compiledChain = CompiledChain<tableSize>::generate(shape);
+
+//==================================================================================
+/** Base wavetables built into the plugin, ready with no generation, cache file or startup cost.
+
+    Only the sizes in compiledSizes are built in, as each adds its chains to the binary and to the build time.
+    Anything else, including every user-defined shape, comes from WavetableCreator at runtime.
+*/
+class CompiledWavetables
+{
+public:
+    /** Returns true if the base tables of tableSize are built in.
+
+    */
+    static constexpr bool isCompiled(int tableSize) noexcept
+    {
+        return tableSize == 2048;
+    }
+
+    /** Returns a chain reading the built-in table of shape at tableSize, or nullptr if that size isn't built in.
+
+        The chain is read-only, and costs only its level list: the samples stay in the binary.
+    */
+    static std::unique_ptr<MipmappedWavetable> createTable(WavetableCreator::BaseShape shape, int tableSize)
+    {
+        if (tableSize == 2048)
+        {
+            return wrapChain(getChain<2048>(shape));
+        }
+
+        return nullptr;
+    }
+
+    /** Returns a chain for every base shape at tableSize, in BaseShape order, or an empty vector if that size isn't built in.
+
+    */
+    static std::vector<std::unique_ptr<MipmappedWavetable>> createTables(int tableSize)
+    {
+        std::vector<std::unique_ptr<MipmappedWavetable>> tables;
+
+        if (!isCompiled(tableSize))
+        {
+            return tables;
+        }
+
+        for (int shape = 0; shape < WavetableCreator::numBaseShapes; ++shape)
+        {
+            tables.push_back(createTable((WavetableCreator::BaseShape)shape, tableSize));
+        }
+
+        return tables;
+    }
+
+private:
+    template <int tableSize>
+    static const CompiledChain<tableSize>& getChain(WavetableCreator::BaseShape shape) noexcept
+    {
+        using Shape = WavetableCreator::BaseShape;
+
+        switch (shape)
+        {
+            case Shape::saw:        return compiledChain<tableSize, Shape::saw>;
+            case Shape::ramp:       return compiledChain<tableSize, Shape::ramp>;
+            case Shape::triangle:   return compiledChain<tableSize, Shape::triangle>;
+            case Shape::square:     return compiledChain<tableSize, Shape::square>;
+            case Shape::sine:
+            default:                return compiledChain<tableSize, Shape::sine>;
+        }
+    }
+
+    template <int tableSize>
+    static std::unique_ptr<MipmappedWavetable> wrapChain(const CompiledChain<tableSize>& chain)
+    {
+        using Layout = CompiledChainLayout<tableSize>;
+
+        auto table = std::make_unique<MipmappedWavetable>();
+
+        // The samples are static, so they outlive the chain with no owner to keep alive
+        for (int level = 0; level < Layout::getNumLevels(); ++level)
+        {
+            table->addExternalLevel(chain.samples.data() + Layout::getLevelOffset(level), Layout::getLevelSize(level),
+                                    Layout::getLevelHarmonics(level), MipmappedWavetable::getFrameStrideForSize(Layout::getLevelSize(level)));
+        }
+
+        return table;
+    }
+};
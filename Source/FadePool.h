@@ -0,0 +1,289 @@
+/*
+  ==============================================================================
+
+    FadePool.h
+    Created: 18 Oct 2026 5:46:18am
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Common.h"
+#include "OscillatorBank.h"
+#include "OscillatorSet.h"
+#include "BlockEnvelope.h"
+#include "PitchTable.h"
+
+
+/** A few note fades shared by every voice, so a stolen note can fade out without each voice carrying a second copy of itself.
+
+    When a voice is stolen mid-note, it hands its oscillators and gain envelope to a slot, which plays them out
+    through a fast release while the voice gets on with its new note. Fades only last a few milliseconds,
+    so a handful of slots covers any realistic rate of steals, and memory scales with concurrent fades
+    rather than with polyphony.
+
+    Slots are rendered by the synthesiser alongside the voices, and follow new OscillatorSets like voices do,
+    so the tables they read stay alive. A fade holds the pitch bend it started with.
+
+    Everything happens on the audio thread, and nothing allocates after prepareToPlay.
+*/
+class FadePool
+{
+public:
+    // Fades that can sound at once. A steal with every slot busy takes over the quietest fade
+    static constexpr int defaultNumSlots = 8;
+
+    explicit FadePool(const PitchTable& pitchTableToUse, int numSlots = defaultNumSlots)
+        : pitchTable(pitchTableToUse)
+    {
+        for (int i = 0; i < numSlots; ++i)
+        {
+            slots.push_back(std::make_unique<Slot>());
+        }
+    }
+
+    //==============================================================================
+    /** Sizes the scratch buffers for blocks of up to maximumBlockSize samples. Not for use on the audio thread.
+
+    */
+    void prepareToPlay(int maximumBlockSize)
+    {
+        for (auto& slot : slots)
+        {
+            slot->envelopeBlock.setSize(1, maximumBlockSize, false, false, true);
+        }
+
+        oscillatorBuffer.setSize(2, maximumBlockSize, false, false, true);
+    }
+
+    int getNumSlots() const noexcept
+    {
+        return (int)slots.size();
+    }
+
+    /** Returns the number of fades still sounding.
+
+    */
+    int getNumActiveFades() const noexcept
+    {
+        int numActive = 0;
+
+        for (auto& slot : slots)
+        {
+            numActive += slot->active ? 1 : 0;
+        }
+
+        return numActive;
+    }
+
+    /** Returns the oscillators a slot is fading, or last faded.
+
+    */
+    const OscillatorBank& getSlotOscillators(int index) const noexcept
+    {
+        return slots[(size_t)index]->oscillators;
+    }
+
+    /** Returns true if any fade's oscillators are panned, so should be rendered in stereo.
+
+    */
+    bool isPanned() const noexcept
+    {
+        for (auto& slot : slots)
+        {
+            if (slot->active && slot->oscillators.isPanned())
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    //==============================================================================
+    /** Takes over a note being stolen: its oscillators, as they are, and its gain envelope, released over releaseTime seconds from its current level.
+
+        velocityLevel scales the envelope, as it did for the note. If there's no slot at all, the note is simply cut.
+    */
+    void startFade(const OscillatorBank& bank, const BlockEnvelope& envelope, float velocityLevel, float releaseTime) noexcept
+    {
+        Slot* slot = findSlotForFade();
+
+        if (slot == nullptr)
+        {
+            return;
+        }
+
+        slot->oscillators.copyStateFrom(bank);
+        slot->velocityLevel = velocityLevel;
+
+        // Nothing glides a fade's pitch, so it's held where the note's bend was headed. Copied part way through
+        // a glide, the oscillators would otherwise keep adding its step to their increment for the whole fade
+        slot->oscillators.setPitchRatio(bank.getPitchRatio());
+
+        // An immediate fast release from wherever the note's envelope has got to
+        BlockEnvelope::Parameters fadeParameters;
+        fadeParameters.attack = 0.0f;
+        fadeParameters.decay = 0.0f;
+        fadeParameters.sustain = envelope.getLevel();
+        fadeParameters.release = releaseTime;
+
+        slot->envelope = envelope;
+        slot->envelope.setParameters(fadeParameters);
+        slot->envelope.noteOff();
+
+        slot->active = slot->envelope.isActive();
+    }
+
+    /** Brings every fade's oscillators in line with set. Oscillators new to the set stay silent.
+
+    */
+    void applyOscillatorSet(const OscillatorSet& set)
+    {
+        for (auto& slot : slots)
+        {
+            if (slot->active)
+            {
+                slot->oscillators.applyOscillatorSet(set, pitchTable, -1);
+            }
+        }
+    }
+
+    //==============================================================================
+    // ===========================
+    // ====== SAMPLE OUTPUT ======
+    // ===========================
+    /** Adds the next numSamples of every fade into left, and into right if it isn't null, then ends any that have finished.
+
+        numSamples must not exceed the size passed to prepareToPlay.
+    */
+    void renderBlock(float* left, float* right, int numSamples) noexcept
+    {
+        float* oscLeft = oscillatorBuffer.getWritePointer(0);
+        float* oscRight = oscillatorBuffer.getWritePointer(1);
+
+        for (auto& slot : slots)
+        {
+            if (!slot->active)
+            {
+                continue;
+            }
+
+            const float* envelope = prepareSlot(*slot, numSamples);
+
+            FloatVectorOperations::clear(oscLeft, numSamples);
+
+            if (right == nullptr)
+            {
+                slot->oscillators.renderBlock(oscLeft, numSamples, 1.0f);
+            }
+            else
+            {
+                FloatVectorOperations::clear(oscRight, numSamples);
+
+                slot->oscillators.renderBlockStereo(oscLeft, oscRight, numSamples, 1.0f);
+                FloatVectorOperations::addWithMultiply(right, oscRight, envelope, numSamples);
+            }
+
+            FloatVectorOperations::addWithMultiply(left, oscLeft, envelope, numSamples);
+        }
+
+        finishBlock();
+    }
+
+   #if SYNTHFRAMEWORK_SSE_LANES
+    /** Adds a lane for every oscillator of every fade to lanes, scaled by its fade's envelope.
+
+        Call finishBlock once lanes has been rendered.
+    */
+    void addToLanes(OscillatorLanes& lanes, int numSamples) noexcept
+    {
+        for (auto& slot : slots)
+        {
+            if (slot->active)
+            {
+                slot->oscillators.addToLanes(lanes, 1.0f, prepareSlot(*slot, numSamples));
+            }
+        }
+    }
+   #endif
+
+    /** Frees the slots of fades whose release finished in the block just rendered.
+
+    */
+    void finishBlock() noexcept
+    {
+        for (auto& slot : slots)
+        {
+            if (slot->active && !slot->envelope.isActive())
+            {
+                slot->active = false;
+            }
+        }
+    }
+
+private:
+    //==============================================================================
+    struct Slot
+    {
+        OscillatorBank oscillators;
+        BlockEnvelope envelope;
+        float velocityLevel = 0.0f;
+        bool active = false;
+
+        // The envelope for the block being rendered, already scaled by velocity
+        AudioBuffer<float> envelopeBlock;
+    };
+
+    const PitchTable& pitchTable;
+
+    // Slots are never added or removed after construction
+    std::vector<std::unique_ptr<Slot>> slots;
+
+    // Scratch space each fade's oscillators are summed into before its envelope is applied
+    AudioBuffer<float> oscillatorBuffer;
+
+    /** Returns a free slot, or failing that the quietest fade, or nullptr if there are no slots.
+
+    */
+    Slot* findSlotForFade() noexcept
+    {
+        Slot* quietest = nullptr;
+
+        for (auto& slot : slots)
+        {
+            if (!slot->active)
+            {
+                return slot.get();
+            }
+
+            if (quietest == nullptr || slot->envelope.getLevel() * slot->velocityLevel < quietest->envelope.getLevel() * quietest->velocityLevel)
+            {
+                quietest = slot.get();
+            }
+        }
+
+        return quietest;
+    }
+
+    /** Moves a slot's frame positions on and renders its envelope for the next numSamples, returning the envelope.
+
+    */
+    const float* prepareSlot(Slot& slot, int numSamples) noexcept
+    {
+        jassert(numSamples <= slot.envelopeBlock.getNumSamples());
+
+        slot.oscillators.advanceFramePositions(numSamples);
+
+        float* envelope = slot.envelopeBlock.getWritePointer(0);
+        slot.envelope.renderBlock(envelope, numSamples, slot.velocityLevel);
+
+        return envelope;
+    }
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FadePool)
+};
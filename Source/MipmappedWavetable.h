@@ -0,0 +1,360 @@
+/*
+  ==============================================================================
+
+    MipmappedWavetable.h
+    Created: 17 Oct 2026 11:02:37am
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "WavetableSampleFormat.h"
+
+
+/** A waveform of one or more single-cycle frames, stored as a chain of band-limited tables, one per octave.
+
+    Level 0 holds the most harmonics and the largest table. Each following level holds
+    half the harmonics of the one before it in a table half the size (down to a minimum),
+    so higher notes read from smaller tables that can't alias.
+
+    Every frame of a level is surrounded by guard samples: copies of its last few samples before its first,
+    and of its first few after its last. Every interpolation kernel reads its neighbours straight from memory,
+    so none of them ever needs to wrap an index.
+
+    All the frames of a level sit in one contiguous block, each starting on a cache line, so scanning
+    from frame to frame streams through memory rather than jumping between separate buffers.
+
+    Samples are floats unless the chain is made with a compact WavetableSampleFormat, in which case each frame
+    of each level also has a scale to multiply its decoded samples by.
+*/
+class MipmappedWavetable
+{
+public:
+    // Samples copied before each frame from its end, and after it from its start. Enough for the widest interpolation kernel
+    static constexpr int guardSamplesBefore = 3;
+    static constexpr int guardSamplesAfter = 4;
+
+    /** Creates an empty chain whose levels will each hold numFramesToUse frames of samples in formatToUse.
+
+    */
+    explicit MipmappedWavetable(int numFramesToUse = 1, WavetableSampleFormat formatToUse = WavetableSampleFormat::float32)
+        : numFrames(numFramesToUse),
+          sampleFormat(formatToUse)
+    {
+        jassert(numFrames > 0);
+    }
+
+    //==============================================================================
+    /** Adds a zeroed level of tableSize samples per frame holding harmonics up to maxHarmonic, with every frame's scale set to 1.
+
+        Levels must be added in order, each holding half the harmonics of the previous one.
+    */
+    void addLevel(int tableSize, int maxHarmonic)
+    {
+        jassert(isPowerOfTwo(tableSize));
+        jassert(levels.empty() || maxHarmonic == jmax(1, levels.back().harmonics / 2));
+
+        Level level;
+        level.size = tableSize;
+        level.harmonics = maxHarmonic;
+        level.frameStride = getFrameStrideForSize(tableSize, sampleFormat);
+
+        // Over-allocate by a cache line, so the first frame can start on one
+        size_t numBytes = (size_t)level.frameStride * (size_t)numFrames * (size_t)getBytesPerSample(sampleFormat);
+        level.storage.calloc(numBytes + cacheLineBytes);
+
+        auto address = reinterpret_cast<uintptr_t>(level.storage.get());
+        auto aligned = (address + cacheLineBytes - 1) & ~(uintptr_t)(cacheLineBytes - 1);
+        level.data = reinterpret_cast<char*>(aligned);
+
+        level.frameScales.malloc((size_t)numFrames);
+        std::fill(level.frameScales.get(), level.frameScales.get() + numFrames, 1.0f);
+
+        levels.push_back(std::move(level));
+    }
+
+    /** Adds a level that reads its frames from samples stored elsewhere, such as in a memory-mapped cache, instead of copying them.
+
+        samples is the start of the first frame's guard samples, laid out as getLevelStorage returns them: each frame starts
+        frameStride samples after the one before, guard samples included. The samples must stay alive for as long as the chain does,
+        either because they're static, such as tables compiled into the plugin, or through keepStorageAlive. A chain with external
+        levels is read-only.
+    */
+    void addExternalLevel(const float* samples, int tableSize, int maxHarmonic, int frameStride)
+    {
+        jassert(isPowerOfTwo(tableSize));
+        jassert(frameStride >= guardSamplesBefore + tableSize + guardSamplesAfter);
+        jassert(levels.empty() || maxHarmonic == jmax(1, levels.back().harmonics / 2));
+        jassert(sampleFormat == WavetableSampleFormat::float32);
+
+        Level level;
+        level.size = tableSize;
+        level.harmonics = maxHarmonic;
+        level.frameStride = frameStride;
+
+        // Nothing writes to a chain with external storage
+        level.data = reinterpret_cast<char*>(const_cast<float*>(samples));
+        externalLevels = true;
+
+        level.frameScales.malloc((size_t)numFrames);
+        std::fill(level.frameScales.get(), level.frameScales.get() + numFrames, 1.0f);
+
+        levels.push_back(std::move(level));
+    }
+
+    /** Holds on to whatever owns the samples of external levels, releasing it with the chain. Not needed for static samples.
+
+    */
+    void keepStorageAlive(std::shared_ptr<const void> storage)
+    {
+        externalStorage = std::move(storage);
+    }
+
+    /** Returns the number of octave levels in the chain.
+
+    */
+    int getNumLevels() const noexcept
+    {
+        return (int)levels.size();
+    }
+
+    /** Returns the number of frames in every level.
+
+    */
+    int getNumFrames() const noexcept
+    {
+        return numFrames;
+    }
+
+    /** Returns how every sample in the chain is stored.
+
+    */
+    WavetableSampleFormat getSampleFormat() const noexcept
+    {
+        return sampleFormat;
+    }
+
+    /** Returns the size of a level's table, not counting guard samples.
+
+    */
+    int getLevelSize(int level) const noexcept
+    {
+        return levels[level].size;
+    }
+
+    /** Returns the highest harmonic present in a level.
+
+    */
+    int getLevelHarmonics(int level) const noexcept
+    {
+        return levels[level].harmonics;
+    }
+
+    /** Returns the distance in samples from the start of one frame of a level to the start of the next, guard samples included.
+
+    */
+    int getFrameStride(int level) const noexcept
+    {
+        return levels[level].frameStride;
+    }
+
+    /** Returns a pointer to the first sample of one frame of a float32 chain's level. The guard samples either side can be read too.
+
+    */
+    const float* getLevelReadPointer(int level, int frame = 0) const noexcept
+    {
+        return getLevelSamples<float>(level, frame);
+    }
+
+    float* getLevelWritePointer(int level, int frame = 0) noexcept
+    {
+        return getLevelSamplesForWriting<float>(level, frame);
+    }
+
+    /** Returns a pointer to the first sample of one frame of a level, as the chain's sample type.
+
+        SampleType must be the Type of the chain's WavetableSampleTraits.
+    */
+    template <typename SampleType>
+    const SampleType* getLevelSamples(int level, int frame = 0) const noexcept
+    {
+        jassert(sizeof(SampleType) == (size_t)getBytesPerSample(sampleFormat));
+        return reinterpret_cast<const SampleType*>(getFrameData(level, frame));
+    }
+
+    template <typename SampleType>
+    SampleType* getLevelSamplesForWriting(int level, int frame = 0) noexcept
+    {
+        // External levels may be mapped read-only
+        jassert(!externalLevels);
+        jassert(sizeof(SampleType) == (size_t)getBytesPerSample(sampleFormat));
+
+        return reinterpret_cast<SampleType*>(const_cast<char*>(getFrameData(level, frame)));
+    }
+
+    /** Returns one frame of a level, as untyped samples of the chain's format.
+
+    */
+    const void* getLevelData(int level, int frame = 0) const noexcept
+    {
+        return getFrameData(level, frame);
+    }
+
+    /** Returns the start of a level's frames as they sit in memory, with the first frame's guard samples first.
+
+        Every frame of the level follows, getFrameStride samples apart. This is the layout addExternalLevel takes.
+    */
+    const void* getLevelStorage(int level) const noexcept
+    {
+        return levels[level].data;
+    }
+
+    /** Copies the end of a frame into the guard samples before it, and its start into the guard samples after it.
+
+        Call once a frame's samples are written, before it's read.
+    */
+    void fillGuardSamples(int level, int frame) noexcept
+    {
+        jassert(!externalLevels);
+
+        size_t bytesPerSample = (size_t)getBytesPerSample(sampleFormat);
+        size_t size = (size_t)levels[level].size;
+        char* samples = const_cast<char*>(getFrameData(level, frame));
+
+        std::memcpy(samples - guardSamplesBefore * bytesPerSample, samples + (size - guardSamplesBefore) * bytesPerSample,
+                    guardSamplesBefore * bytesPerSample);
+        std::memcpy(samples + size * bytesPerSample, samples, guardSamplesAfter * bytesPerSample);
+    }
+
+    /** Returns what a frame's decoded samples must be multiplied by. Always 1 for float32 chains.
+
+    */
+    float getFrameScale(int level, int frame = 0) const noexcept
+    {
+        jassert(isPositiveAndBelow(frame, numFrames));
+        return levels[level].frameScales[frame];
+    }
+
+    void setFrameScale(int level, int frame, float newScale) noexcept
+    {
+        jassert(isPositiveAndBelow(frame, numFrames));
+        jassert(sampleFormat != WavetableSampleFormat::float32 || newScale == 1.0f);
+
+        levels[level].frameScales[frame] = newScale;
+    }
+
+    /** Returns the number of bytes taken by the samples of every frame of every level.
+
+    */
+    size_t getSizeInBytes() const noexcept
+    {
+        size_t numBytes = 0;
+
+        for (const Level& level : levels)
+        {
+            numBytes += (size_t)getBytesPerSample(sampleFormat) * (size_t)level.frameStride * (size_t)numFrames;
+        }
+
+        return numBytes;
+    }
+
+    /** Returns true if the levels read samples owned elsewhere, added with addExternalLevel.
+
+    */
+    bool hasExternalStorage() const noexcept
+    {
+        return externalLevels;
+    }
+
+    /** Returns the frame stride used for levels of tableSize: the table and its guard samples, rounded up to a whole cache line.
+
+    */
+    static constexpr int getFrameStrideForSize(int tableSize, WavetableSampleFormat format = WavetableSampleFormat::float32) noexcept
+    {
+        int samplesPerCacheLine = cacheLineBytes / getBytesPerSample(format);
+        int samplesPerFrame = guardSamplesBefore + tableSize + guardSamplesAfter;
+
+        return (samplesPerFrame + samplesPerCacheLine - 1) / samplesPerCacheLine * samplesPerCacheLine;
+    }
+
+    //==============================================================================
+    /** Returns the level with the most harmonics that can be played at frequency without aliasing.
+
+        O(1): the octave is read straight from the exponent of the harmonic/Nyquist ratio.
+    */
+    int getLevelIndexForFrequency(double frequency, double sampleRate) const noexcept
+    {
+        jassert(!levels.empty());
+
+        if (frequency <= 0.0 || sampleRate <= 0.0)
+        {
+            return 0;
+        }
+
+        // How far the highest harmonic of level 0 would land above Nyquist
+        double ratio = (double)levels[0].harmonics * frequency / (sampleRate * 0.5);
+
+        if (ratio <= 1.0)
+        {
+            return 0;
+        }
+
+        // ratio = mantissa * 2^exponent with mantissa in [0.5, 1), so ceil(log2(ratio)) is the exponent,
+        // less one if ratio is an exact power of two
+        int exponent;
+        double mantissa = std::frexp(ratio, &exponent);
+        int level = (mantissa == 0.5) ? exponent - 1 : exponent;
+
+        return jmin(level, getNumLevels() - 1);
+    }
+
+private:
+    static constexpr int cacheLineBytes = 64;
+
+    struct Level
+    {
+        int size = 0;
+        int harmonics = 0;
+
+        // In samples
+        int frameStride = 0;
+
+        // First byte of frame 0's guard samples, aligned to a cache line if owned
+        char* data = nullptr;
+
+        // Empty for external levels
+        HeapBlock<char> storage;
+
+        // One per frame
+        HeapBlock<float> frameScales;
+    };
+
+    // Most harmonics first
+    std::vector<Level> levels;
+
+    int numFrames = 1;
+    WavetableSampleFormat sampleFormat = WavetableSampleFormat::float32;
+
+    // Set once any level is added with addExternalLevel, after which the chain is read-only
+    bool externalLevels = false;
+
+    // Owner of the samples of any external levels, or null if nothing owns them, as for static samples
+    std::shared_ptr<const void> externalStorage;
+
+    // The first sample of a frame, after its guard samples
+    const char* getFrameData(int level, int frame) const noexcept
+    {
+        jassert(isPositiveAndBelow(frame, numFrames));
+
+        size_t bytesPerSample = (size_t)getBytesPerSample(sampleFormat);
+        size_t frameBytes = (size_t)levels[level].frameStride * bytesPerSample;
+
+        return levels[level].data + (size_t)frame * frameBytes + guardSamplesBefore * bytesPerSample;
+    }
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MipmappedWavetable)
+};
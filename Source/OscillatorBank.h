@@ -0,0 +1,410 @@
+/*
+  ==============================================================================
+
+    OscillatorBank.h
+    Created: 17 Oct 2026 1:47:12pm
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Common.h"
+#include "ParameterSnapshot.h"
+#include "OscillatorSet.h"
+#include "WavetableOscillator.h"
+
+#include "OscillatorLanes.h"
+
+
+/** A fixed-capacity set of oscillators stored by value, rendered several at a time.
+
+    The oscillators themselves sit in one contiguous array. Once per block, every oscillator
+    that can play is packed into OscillatorLanes and rendered four at a time with SSE, or eight with AVX2. Banks
+    can also add their oscillators to a shared set of lanes, so oscillators from several
+    voices are rendered together.
+
+    The vector path needs the fixed-point phase engine. With SYNTHFRAMEWORK_FIXED_POINT_PHASE
+    set to 0, or without SSE2, each oscillator renders on its own instead.
+*/
+class OscillatorBank
+{
+public:
+    // Most oscillators a bank can hold
+    static constexpr int maxOscillators = ParameterSnapshot::maxOscillators;
+
+    OscillatorBank()
+       #if SYNTHFRAMEWORK_SSE_LANES
+        : lanes(maxOscillators)
+       #endif
+    {
+        enabled.fill(true);
+        pans.fill(0.0f);
+        ids.fill(0);
+    }
+
+    //==============================================================================
+    // ===================================
+    // ====== OSCILLATOR MANAGEMENT ======
+    // ===================================
+    /** Returns the number of oscillators in the bank.
+
+    */
+    int getNumOscillators() const noexcept
+    {
+        return numOscillators;
+    }
+
+    WavetableOscillator& getOscillator(int index) noexcept
+    {
+        jassert(index < numOscillators);
+        return oscillators[index];
+    }
+
+    const WavetableOscillator& getOscillator(int index) const noexcept
+    {
+        jassert(index < numOscillators);
+        return oscillators[index];
+    }
+
+    /** Brings the bank in line with set, without allocating. Safe to call from the audio thread.
+
+        Oscillators are matched to the set by id, so ones that are kept hold their phase, detune, pan and
+        enabled state, even if they've moved. New oscillators start tuned from pitchTable at the given note
+        and the bank's pitch bend, enabled and centred. Oscillators no longer in the set are dropped. Oscillators only hold raw pointers
+        to their wavetables, which the set owns, so nothing here touches a reference count.
+    */
+    void applyOscillatorSet(const OscillatorSet& set, const PitchTable& pitchTable, int note)
+    {
+        jassert(set.numOscillators <= maxOscillators);
+
+        int numSlots = jmax(numOscillators, set.numOscillators);
+
+        // Slots past the current oscillators hold nothing to keep
+        for (int i = numOscillators; i < numSlots; ++i)
+        {
+            ids[i] = 0;
+        }
+
+        // Rearranged in place, one slot at a time. A bit is set for each slot that holds its final oscillator.
+        // Any other slot still holds an old oscillator that a later slot may want, or nothing
+        uint32 placedSlots = 0;
+
+        for (int i = 0; i < set.numOscillators; ++i)
+        {
+            int existingIndex = indexOfUnplacedId(set.oscillators[i].id, numSlots, placedSlots);
+
+            if (existingIndex >= 0)
+            {
+                swapSlots(i, existingIndex);
+                placedSlots |= 1u << i;
+            }
+        }
+
+        for (int i = 0; i < set.numOscillators; ++i)
+        {
+            const OscillatorSet::Entry& entry = set.oscillators[i];
+
+            if ((placedSlots & (1u << i)) != 0)
+            {
+                if (oscillators[i].getWavetable() != entry.wavetable.get())
+                {
+                    oscillators[i].setWavetable(entry.wavetable.get());
+                }
+            }
+            else
+            {
+                oscillators[i] = WavetableOscillator(entry.wavetable.get());
+                oscillators[i].setPitchTable(pitchTable);
+                oscillators[i].setPitchRatio(pitchRatio);
+                oscillators[i].setNote(note);
+                oscillators[i].setInterpolation(interpolation);
+
+                enabled[i] = true;
+                pans[i] = 0.0f;
+                ids[i] = entry.id;
+            }
+
+            oscillators[i].setOscNumber(i);
+        }
+
+        // Clear slots no longer in use, so they can't point at a wavetable the set no longer keeps alive
+        for (int i = set.numOscillators; i < numOscillators; ++i)
+        {
+            oscillators[i] = WavetableOscillator();
+        }
+
+        numOscillators = set.numOscillators;
+    }
+
+    /** Copies every oscillator and its settings from other, so this bank carries on exactly where other is. Doesn't allocate.
+
+    */
+    void copyStateFrom(const OscillatorBank& other) noexcept
+    {
+        for (int i = 0; i < other.numOscillators; ++i)
+        {
+            oscillators[i] = other.oscillators[i];
+            enabled[i] = other.enabled[i];
+            pans[i] = other.pans[i];
+            ids[i] = other.ids[i];
+        }
+
+        // As in applyOscillatorSet, unused slots mustn't keep pointing at wavetables
+        for (int i = other.numOscillators; i < numOscillators; ++i)
+        {
+            oscillators[i] = WavetableOscillator();
+        }
+
+        numOscillators = other.numOscillators;
+        pitchRatio = other.pitchRatio;
+
+        setInterpolation(other.interpolation);
+    }
+
+    /** Sets whether an oscillator is rendered. Disabled oscillators hold their phase.
+
+    */
+    void setEnabled(int index, bool shouldBeEnabled) noexcept
+    {
+        enabled[index] = shouldBeEnabled;
+    }
+
+    int getNumEnabledOscillators() const noexcept
+    {
+        int numEnabled = 0;
+
+        for (int i = 0; i < numOscillators; ++i)
+        {
+            numEnabled += enabled[i] ? 1 : 0;
+        }
+
+        return numEnabled;
+    }
+
+    /** Sets an oscillator's pan, from -1 (left) to 1 (right). Only used when rendering in stereo.
+
+    */
+    void setPan(int index, float newPan) noexcept
+    {
+        pans[index] = newPan;
+    }
+
+    /** Returns true if any enabled oscillator is panned away from the centre, so needs rendering in stereo.
+
+    */
+    bool isPanned() const noexcept
+    {
+        for (int i = 0; i < numOscillators; ++i)
+        {
+            if (enabled[i] && pans[i] != 0.0f)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // =============================
+    // ====== SHARED SETTINGS ======
+    // =============================
+    void setNote(int note)
+    {
+        for (int i = 0; i < numOscillators; ++i)
+        {
+            oscillators[i].setNote(note);
+        }
+    }
+
+    void setPitchTable(const PitchTable& pitchTable)
+    {
+        for (int i = 0; i < numOscillators; ++i)
+        {
+            oscillators[i].setPitchTable(pitchTable);
+        }
+    }
+
+    /** Sets the pitch bend ratio of every oscillator straight away, including any added later. For the start of a note.
+
+    */
+    void setPitchRatio(double newRatio)
+    {
+        pitchRatio = newRatio;
+
+        for (int i = 0; i < numOscillators; ++i)
+        {
+            oscillators[i].setPitchRatio(newRatio);
+        }
+    }
+
+    /** Returns the pitch bend ratio the bank is at, or heading to if it's part way through a glide.
+
+    */
+    double getPitchRatio() const noexcept
+    {
+        return pitchRatio;
+    }
+
+    /** Glides every oscillator's pitch bend ratio to newRatio across the next numSamples. Call once per block, before rendering it.
+
+    */
+    void rampPitchRatio(double newRatio, int numSamples) noexcept
+    {
+        pitchRatio = newRatio;
+
+        for (int i = 0; i < numOscillators; ++i)
+        {
+            oscillators[i].rampPitchRatio(newRatio, numSamples);
+        }
+    }
+
+    /** Sets the kernel every oscillator in the bank is read with, including any added later.
+
+    */
+    void setInterpolation(InterpolationMode newMode) noexcept
+    {
+        interpolation = newMode;
+
+        for (int i = 0; i < numOscillators; ++i)
+        {
+            oscillators[i].setInterpolation(newMode);
+        }
+
+       #if SYNTHFRAMEWORK_SSE_LANES
+        lanes.setInterpolation(newMode);
+       #endif
+    }
+
+    /** Moves every oscillator's frame position on towards its target, ready to render the next numSamples.
+
+    */
+    void advanceFramePositions(int numSamples) noexcept
+    {
+        for (int i = 0; i < numOscillators; ++i)
+        {
+            oscillators[i].advanceFramePosition(numSamples);
+        }
+    }
+
+    /** Resets every oscillator to the start of its cycle, to play a new note.
+
+    */
+    void resetPhases()
+    {
+        for (int i = 0; i < numOscillators; ++i)
+        {
+            oscillators[i].resetIndex();
+        }
+    }
+
+    //==============================================================================
+    // ===========================
+    // ====== SAMPLE OUTPUT ======
+    // ===========================
+    /** Adds the next numSamples of every enabled oscillator, scaled by gain, into dest.
+
+    */
+    void renderBlock(float* dest, int numSamples, float gain) noexcept
+    {
+       #if SYNTHFRAMEWORK_SSE_LANES
+        lanes.clear();
+        addToLanes(lanes, gain, nullptr);
+        lanes.render(dest, numSamples);
+       #else
+        for (int i = 0; i < numOscillators; ++i)
+        {
+            if (enabled[i])
+            {
+                oscillators[i].renderBlock(dest, numSamples, gain);
+            }
+        }
+       #endif
+    }
+
+    /** Adds the next numSamples of every enabled oscillator into left and right, scaled by gain and panned by each oscillator's pan.
+
+    */
+    void renderBlockStereo(float* left, float* right, int numSamples, float gain) noexcept
+    {
+       #if SYNTHFRAMEWORK_SSE_LANES
+        lanes.clear();
+        addToLanes(lanes, gain, nullptr);
+        lanes.renderStereo(left, right, numSamples);
+       #else
+        for (int i = 0; i < numOscillators; ++i)
+        {
+            if (enabled[i])
+            {
+                oscillators[i].renderBlock(left, right, numSamples,
+                                           gain * WavetableOscillator::getPanGain(pans[i], false),
+                                           gain * WavetableOscillator::getPanGain(pans[i], true));
+            }
+        }
+       #endif
+    }
+
+   #if SYNTHFRAMEWORK_SSE_LANES
+    /** Adds a lane to lanesToFill for every enabled oscillator that can play, to be rendered with lanes from other banks.
+
+        See OscillatorLanes::addOscillator for how gain and envelope are applied.
+    */
+    void addToLanes(OscillatorLanes& lanesToFill, float gain, const float* envelope) noexcept
+    {
+        for (int i = 0; i < numOscillators; ++i)
+        {
+            if (enabled[i])
+            {
+                lanesToFill.addOscillator(oscillators[i], gain, envelope, pans[i]);
+            }
+        }
+    }
+   #endif
+
+private:
+    //==============================================================================
+    std::array<WavetableOscillator, maxOscillators> oscillators;
+    std::array<bool, maxOscillators> enabled;
+    std::array<float, maxOscillators> pans;
+    // The OscillatorSet id of each oscillator
+    std::array<uint32, maxOscillators> ids;
+    int numOscillators = 0;
+
+    InterpolationMode interpolation = InterpolationMode::linear;
+    double pitchRatio = 1.0;
+
+    // The first of the first numSlots slots, not set in placedSlots, holding the oscillator with id, or -1 if none does
+    int indexOfUnplacedId(uint32 id, int numSlots, uint32 placedSlots) const noexcept
+    {
+        for (int i = 0; i < numSlots; ++i)
+        {
+            if ((placedSlots & (1u << i)) == 0 && ids[i] == id)
+            {
+                return i;
+            }
+        }
+
+        return -1;
+    }
+
+    void swapSlots(int a, int b) noexcept
+    {
+        if (a != b)
+        {
+            std::swap(oscillators[a], oscillators[b]);
+            std::swap(enabled[a], enabled[b]);
+            std::swap(pans[a], pans[b]);
+            std::swap(ids[a], ids[b]);
+        }
+    }
+
+   #if SYNTHFRAMEWORK_SSE_LANES
+    // Lanes for rendering this bank on its own
+    OscillatorLanes lanes;
+   #endif
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OscillatorBank)
+};
@@ -0,0 +1,711 @@
+/*
+  ==============================================================================
+
+    OscillatorLanes.h
+    Created: 17 Oct 2026 3:05:48pm
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Common.h"
+#include "WavetableOscillator.h"
+
+#if SYNTHFRAMEWORK_FIXED_POINT_PHASE && (defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2))
+ #define SYNTHFRAMEWORK_SSE_LANES 1
+ #include <emmintrin.h>
+#else
+ #define SYNTHFRAMEWORK_SSE_LANES 0
+#endif
+
+#if SYNTHFRAMEWORK_SSE_LANES
+
+/** Renders many oscillators together by packing their render state into structure-of-arrays lanes.
+
+    Each lane is one playing oscillator: its phase, increment, gain, table scale and table
+    pointer sit in contiguous arrays, and four lanes are rendered per SSE register, or eight per
+    AVX2 register when built with AVX2 enabled (SYNTHFRAMEWORK_AVX2). A lane can
+    also carry a per-sample envelope, which is how lanes from different voices (each with
+    its own gain envelope) can share a register. Increments ramp by a per-lane step, so pitch
+    bends glide through the block. Phases and increments are written back to the oscillators
+    once the block is done.
+
+    Lanes can be rendered to one channel, or to two with each lane panned by its own
+    left and right gains. Lanes reading multi-frame tables also carry the next frame and
+    the mix between the two, and are read bilinearly: within both frames, then across them.
+
+    Lanes are kept in a separate set for each WavetableSampleFormat, so every group decodes
+    its samples the same way, with the gather followed by one SIMD conversion. Every lane is read with
+    the same interpolation kernel, picked once per render.
+
+    Only available with the fixed-point phase engine and SSE2 (SYNTHFRAMEWORK_SSE_LANES).
+*/
+class OscillatorLanes
+{
+public:
+    // Lanes rendered together in one register
+    static constexpr int laneWidth = SYNTHFRAMEWORK_AVX2 ? 8 : 4;
+
+    OscillatorLanes() = default;
+
+    explicit OscillatorLanes(int maxLanes)
+    {
+        setCapacity(maxLanes);
+    }
+
+    /** Allocates room for maxLanes lanes of each sample format. Not for use on the audio thread.
+
+    */
+    void setCapacity(int maxLanes)
+    {
+        capacity = (maxLanes + laneWidth - 1) / laneWidth * laneWidth;
+
+        for (LaneSet& set : laneSets)
+        {
+            set.allocate(capacity);
+        }
+    }
+
+    int getCapacity() const noexcept
+    {
+        return capacity;
+    }
+
+    int getNumLanes() const noexcept
+    {
+        int numLanes = 0;
+
+        for (const LaneSet& set : laneSets)
+        {
+            numLanes += set.numLanes;
+        }
+
+        return numLanes;
+    }
+
+    /** Removes all lanes, ready to pack the next block.
+
+    */
+    void clear() noexcept
+    {
+        for (LaneSet& set : laneSets)
+        {
+            set.numLanes = 0;
+            set.anyLaneMorphing = false;
+        }
+
+        anyLanePanned = false;
+    }
+
+    /** Sets the kernel every lane is read with from the next render.
+
+    */
+    void setInterpolation(InterpolationMode newMode) noexcept
+    {
+        interpolation = newMode;
+    }
+
+    /** Returns true if any lane added since the last clear is panned away from the centre.
+
+    */
+    bool hasPannedLanes() const noexcept
+    {
+        return anyLanePanned;
+    }
+
+
+    //==============================================================================
+    /** Adds a lane for an oscillator, if it can play.
+
+        Every sample is scaled by gain and, if envelope isn't null, by envelope[sample].
+        Within one set of lanes, either every lane or no lane should have an envelope.
+        pan is only used by renderStereo. Returns false if there was no room left.
+    */
+    bool addOscillator(WavetableOscillator& osc, float gain, const float* envelope, float pan = 0.0f) noexcept
+    {
+        if (!osc.hasDelta())
+        {
+            return true;
+        }
+
+        // Lanes are kept apart by sample format, so every lane in a group decodes the same way
+        LaneSet& set = laneSets[(int)osc.sampleFormat - 1];
+        int lane = set.numLanes;
+
+        if (lane >= capacity)
+        {
+            jassertfalse;
+            return false;
+        }
+
+        jassert(lane == 0 || (envelope == nullptr) == (set.envelopes[0] == nullptr));
+
+        set.phases[lane] = osc.phase.phase;
+        set.increments[lane] = osc.phase.increment;
+        set.incrementSteps[lane] = osc.phase.incrementStep;
+        set.gains[lane] = gain;
+        set.leftGains[lane] = gain * WavetableOscillator::getPanGain(pan, false);
+        set.rightGains[lane] = gain * WavetableOscillator::getPanGain(pan, true);
+        set.scales[lane] = (float)osc.tableSize * (1.0f / 16777216.0f);
+        set.tables[lane] = osc.levelData;
+        set.nextTables[lane] = osc.nextFrameData;
+        set.sampleScales[lane] = osc.levelScale;
+        set.nextSampleScales[lane] = osc.nextFrameScale;
+        set.frameMixes[lane] = osc.frameMix;
+        set.envelopes[lane] = envelope;
+        set.owners[lane] = &osc;
+
+        anyLanePanned |= (pan != 0.0f);
+        set.anyLaneMorphing |= (osc.frameMix != 0.0f);
+
+        ++set.numLanes;
+        return true;
+    }
+
+    /** Adds the sum of every lane for the next numSamples into dest, then writes the advanced phases back.
+
+    */
+    void render(float* dest, int numSamples) noexcept
+    {
+        renderAllLanes<false>(dest, nullptr, numSamples);
+    }
+
+    /** Adds every lane for the next numSamples into left and right, panned by each lane's pan, then writes the advanced phases back.
+
+    */
+    void renderStereo(float* left, float* right, int numSamples) noexcept
+    {
+        renderAllLanes<true>(left, right, numSamples);
+    }
+
+private:
+    //==============================================================================
+    /** The lanes of every oscillator whose table is in one sample format.
+
+    */
+    struct LaneSet
+    {
+        HeapBlock<uint32> phases;
+        HeapBlock<uint32> increments;
+        // Added to each increment every sample, wrapping like the phases
+        HeapBlock<uint32> incrementSteps;
+        HeapBlock<float> gains;
+        // gains, scaled by each side of the lane's pan
+        HeapBlock<float> leftGains;
+        HeapBlock<float> rightGains;
+        // Converts the top 24 bits of a phase to a table position: tableSize / 2^24
+        HeapBlock<float> scales;
+        HeapBlock<const void*> tables;
+        // The frame after each lane's table, and how far to mix towards it
+        HeapBlock<const void*> nextTables;
+        HeapBlock<float> frameMixes;
+        // What each frame's decoded samples are multiplied by
+        HeapBlock<float> sampleScales;
+        HeapBlock<float> nextSampleScales;
+        HeapBlock<const float*> envelopes;
+        // The oscillator each lane was packed from
+        HeapBlock<WavetableOscillator*> owners;
+
+        int numLanes = 0;
+        bool anyLaneMorphing = false;
+
+        void allocate(int capacityToUse)
+        {
+            phases.calloc((size_t)capacityToUse);
+            increments.calloc((size_t)capacityToUse);
+            incrementSteps.calloc((size_t)capacityToUse);
+            gains.calloc((size_t)capacityToUse);
+            leftGains.calloc((size_t)capacityToUse);
+            rightGains.calloc((size_t)capacityToUse);
+            scales.calloc((size_t)capacityToUse);
+            tables.calloc((size_t)capacityToUse);
+            nextTables.calloc((size_t)capacityToUse);
+            frameMixes.calloc((size_t)capacityToUse);
+            sampleScales.calloc((size_t)capacityToUse);
+            nextSampleScales.calloc((size_t)capacityToUse);
+            envelopes.calloc((size_t)capacityToUse);
+            owners.calloc((size_t)capacityToUse);
+
+            numLanes = 0;
+        }
+    };
+
+    LaneSet laneSets[numWavetableSampleFormats];
+
+    int capacity = 0;
+    bool anyLanePanned = false;
+    InterpolationMode interpolation = InterpolationMode::linear;
+
+    // Read by padding lanes, so every lane in a group can load unconditionally. Zero in every format,
+    // with room for any kernel's reads either side
+    static const void* getSilentTable() noexcept
+    {
+        static const float silentTable[MipmappedWavetable::guardSamplesBefore + 1 + MipmappedWavetable::guardSamplesAfter] = {};
+        return silentTable + MipmappedWavetable::guardSamplesBefore;
+    }
+
+    //==============================================================================
+    /** Fills the last group of a set with silent lanes and returns the number of lanes to render, a multiple of laneWidth.
+
+    */
+    int padLanes(LaneSet& set) noexcept
+    {
+        int numPaddedLanes = (set.numLanes + laneWidth - 1) / laneWidth * laneWidth;
+        jassert(numPaddedLanes <= capacity);
+
+        for (int lane = set.numLanes; lane < numPaddedLanes; ++lane)
+        {
+            set.phases[lane] = 0;
+            set.increments[lane] = 0;
+            set.incrementSteps[lane] = 0;
+            set.gains[lane] = 0.0f;
+            set.leftGains[lane] = 0.0f;
+            set.rightGains[lane] = 0.0f;
+            set.scales[lane] = 0.0f;
+            set.tables[lane] = getSilentTable();
+            set.nextTables[lane] = getSilentTable();
+            set.frameMixes[lane] = 0.0f;
+            set.sampleScales[lane] = 0.0f;
+            set.nextSampleScales[lane] = 0.0f;
+            // Any valid envelope will do, as the gain is 0
+            set.envelopes[lane] = set.envelopes[0];
+        }
+
+        return numPaddedLanes;
+    }
+
+    /** Renders the lanes of every sample format into one or two channels, with the kernel for the interpolation mode.
+
+    */
+    template <bool stereo>
+    void renderAllLanes(float* left, float* right, int numSamples) noexcept
+    {
+        withInterpolationKernel(interpolation, [&] (const auto& kernel)
+        {
+            renderLanes<WavetableSampleFormat::float32, stereo>(kernel, laneSets[(int)WavetableSampleFormat::float32 - 1], left, right, numSamples);
+            renderLanes<WavetableSampleFormat::int16, stereo>(kernel, laneSets[(int)WavetableSampleFormat::int16 - 1], left, right, numSamples);
+            renderLanes<WavetableSampleFormat::float16, stereo>(kernel, laneSets[(int)WavetableSampleFormat::float16 - 1], left, right, numSamples);
+        });
+    }
+
+    /** Renders every lane group of a set into one or two channels, then writes the phases and increments back.
+
+    */
+    template <WavetableSampleFormat format, bool stereo, typename Kernel>
+    void renderLanes(const Kernel& kernel, LaneSet& set, float* left, float* right, int numSamples) noexcept
+    {
+        if (set.numLanes == 0)
+        {
+            return;
+        }
+
+        int numPaddedLanes = padLanes(set);
+        bool withEnvelopes = set.envelopes[0] != nullptr;
+
+        for (int firstLane = 0; firstLane < numPaddedLanes; firstLane += laneWidth)
+        {
+            // Only pay for the second frame's loads when some lane is between frames
+            if (set.anyLaneMorphing)
+            {
+                if (withEnvelopes)
+                {
+                    renderLaneGroup<format, true, stereo, true>(kernel, set, firstLane, left, right, numSamples);
+                }
+                else
+                {
+                    renderLaneGroup<format, false, stereo, true>(kernel, set, firstLane, left, right, numSamples);
+                }
+            }
+            else
+            {
+                if (withEnvelopes)
+                {
+                    renderLaneGroup<format, true, stereo, false>(kernel, set, firstLane, left, right, numSamples);
+                }
+                else
+                {
+                    renderLaneGroup<format, false, stereo, false>(kernel, set, firstLane, left, right, numSamples);
+                }
+            }
+        }
+
+        for (int lane = 0; lane < set.numLanes; ++lane)
+        {
+            set.owners[lane]->phase.phase = set.phases[lane];
+            set.owners[lane]->phase.increment = set.increments[lane];
+            set.owners[lane]->finishPitchRamp();
+        }
+    }
+
+   #if SYNTHFRAMEWORK_AVX2
+    /** The per-group state renderLaneSample reads, loaded once per group.
+
+    */
+    struct LaneGroup
+    {
+        __m256i incrementSteps;
+        __m256 scales;
+        __m256 gains;
+        const void* const* tables;
+        const void* const* nextTables;
+        __m256 mixes;
+        __m256 sampleScales;
+        __m256 nextSampleScales;
+    };
+
+    /** Returns one sample from each of eight lanes, interpolated and scaled by their gains, and advances their phases and increments.
+
+        The AVX2 form of the SSE renderLaneSample below: the same steps, eight lanes wide.
+    */
+    template <WavetableSampleFormat format, bool morphing, typename Kernel>
+    static forcedinline __m256 renderLaneSample(const Kernel& kernel, __m256i& laneGroupPhases, __m256i& laneGroupIncrements, const LaneGroup& group) noexcept
+    {
+        using SampleType = typename WavetableSampleTraits<format>::Type;
+        constexpr bool scaled = format != WavetableSampleFormat::float32;
+
+        // Position in table samples, from the top 24 bits of each phase
+        __m256 position = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(laneGroupPhases, 8)), group.scales);
+        __m256i index = _mm256_cvttps_epi32(position);
+        __m256 frac = _mm256_sub_ps(position, _mm256_cvtepi32_ps(index));
+
+        LaneFrameReader8<format> reader;
+
+        for (int lane = 0; lane < 8; ++lane)
+        {
+            reader.samples[lane] = static_cast<const SampleType*>(group.tables[lane]);
+        }
+
+        __m256 value = kernel.interpolate8(reader, index, frac);
+
+        if (scaled)
+        {
+            value = _mm256_mul_ps(value, group.sampleScales);
+        }
+
+        if (morphing)
+        {
+            LaneFrameReader8<format> nextReader;
+
+            for (int lane = 0; lane < 8; ++lane)
+            {
+                nextReader.samples[lane] = static_cast<const SampleType*>(group.nextTables[lane]);
+            }
+
+            __m256 next = kernel.interpolate8(nextReader, index, frac);
+
+            if (scaled)
+            {
+                next = _mm256_mul_ps(next, group.nextSampleScales);
+            }
+
+            value = _mm256_add_ps(value, _mm256_mul_ps(group.mixes, _mm256_sub_ps(next, value)));
+        }
+
+        laneGroupPhases = _mm256_add_epi32(laneGroupPhases, laneGroupIncrements);
+        laneGroupIncrements = _mm256_add_epi32(laneGroupIncrements, group.incrementSteps);
+
+        return _mm256_mul_ps(value, group.gains);
+    }
+
+    /** Transposes eight rows of eight, in place.
+
+    */
+    static forcedinline void transpose8(__m256* rows) noexcept
+    {
+        __m256 pairs[8];
+
+        for (int i = 0; i < 8; i += 2)
+        {
+            pairs[i] = _mm256_unpacklo_ps(rows[i], rows[i + 1]);
+            pairs[i + 1] = _mm256_unpackhi_ps(rows[i], rows[i + 1]);
+        }
+
+        __m256 quads[8];
+
+        for (int i = 0; i < 8; i += 4)
+        {
+            quads[i] = _mm256_shuffle_ps(pairs[i], pairs[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+            quads[i + 1] = _mm256_shuffle_ps(pairs[i], pairs[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+            quads[i + 2] = _mm256_shuffle_ps(pairs[i + 1], pairs[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+            quads[i + 3] = _mm256_shuffle_ps(pairs[i + 1], pairs[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+        }
+
+        // Each 128 bit half now holds a 4x4 block transposed; swap the off-diagonal blocks
+        for (int i = 0; i < 4; ++i)
+        {
+            rows[i] = _mm256_permute2f128_ps(quads[i], quads[i + 4], 0x20);
+            rows[i + 4] = _mm256_permute2f128_ps(quads[i], quads[i + 4], 0x31);
+        }
+    }
+
+    /** Adds the sum of eight lanes into left, and into right when rendering in stereo.
+
+        As the SSE renderLaneGroup below, with eight samples rendered per step and transposed eight by eight.
+    */
+    template <WavetableSampleFormat format, bool withEnvelopes, bool stereo, bool morphing, typename Kernel>
+    void renderLaneGroup(const Kernel& kernel, LaneSet& set, int firstLane, float* left, float* right, int numSamples) noexcept
+    {
+        LaneGroup group;
+        group.incrementSteps = _mm256_loadu_si256((const __m256i*)(set.incrementSteps + firstLane));
+        group.scales = _mm256_loadu_ps(set.scales + firstLane);
+        group.gains = stereo ? _mm256_set1_ps(1.0f) : _mm256_loadu_ps(set.gains + firstLane);
+        group.tables = set.tables + firstLane;
+        group.nextTables = set.nextTables + firstLane;
+        group.mixes = _mm256_loadu_ps(set.frameMixes + firstLane);
+        group.sampleScales = _mm256_loadu_ps(set.sampleScales + firstLane);
+        group.nextSampleScales = _mm256_loadu_ps(set.nextSampleScales + firstLane);
+
+        __m256i groupPhases = _mm256_loadu_si256((const __m256i*)(set.phases + firstLane));
+        __m256i groupIncrements = _mm256_loadu_si256((const __m256i*)(set.increments + firstLane));
+        const float* const* groupEnvelopes = set.envelopes + firstLane;
+        const float* groupLeftGains = set.leftGains + firstLane;
+        const float* groupRightGains = set.rightGains + firstLane;
+
+        int sample = 0;
+
+        for (; sample + 8 <= numSamples; sample += 8)
+        {
+            __m256 rows[8];
+
+            for (int row = 0; row < 8; ++row)
+            {
+                rows[row] = renderLaneSample<format, morphing>(kernel, groupPhases, groupIncrements, group);
+            }
+
+            // Rows become lanes: each now holds eight consecutive samples of one oscillator
+            transpose8(rows);
+
+            if (withEnvelopes)
+            {
+                for (int lane = 0; lane < 8; ++lane)
+                {
+                    rows[lane] = _mm256_mul_ps(rows[lane], _mm256_loadu_ps(groupEnvelopes[lane] + sample));
+                }
+            }
+
+            if (stereo)
+            {
+                __m256 sumLeft = _mm256_mul_ps(rows[0], _mm256_set1_ps(groupLeftGains[0]));
+                __m256 sumRight = _mm256_mul_ps(rows[0], _mm256_set1_ps(groupRightGains[0]));
+
+                for (int lane = 1; lane < 8; ++lane)
+                {
+                    sumLeft = _mm256_add_ps(sumLeft, _mm256_mul_ps(rows[lane], _mm256_set1_ps(groupLeftGains[lane])));
+                    sumRight = _mm256_add_ps(sumRight, _mm256_mul_ps(rows[lane], _mm256_set1_ps(groupRightGains[lane])));
+                }
+
+                _mm256_storeu_ps(left + sample, _mm256_add_ps(_mm256_loadu_ps(left + sample), sumLeft));
+                _mm256_storeu_ps(right + sample, _mm256_add_ps(_mm256_loadu_ps(right + sample), sumRight));
+            }
+            else
+            {
+                __m256 sum = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(rows[0], rows[1]), _mm256_add_ps(rows[2], rows[3])),
+                                           _mm256_add_ps(_mm256_add_ps(rows[4], rows[5]), _mm256_add_ps(rows[6], rows[7])));
+                _mm256_storeu_ps(left + sample, _mm256_add_ps(_mm256_loadu_ps(left + sample), sum));
+            }
+        }
+
+        // Remaining samples, summed across lanes one at a time
+        for (; sample < numSamples; ++sample)
+        {
+            alignas(32) float laneSamples[laneWidth];
+            _mm256_store_ps(laneSamples, renderLaneSample<format, morphing>(kernel, groupPhases, groupIncrements, group));
+
+            if (withEnvelopes)
+            {
+                for (int lane = 0; lane < laneWidth; ++lane)
+                {
+                    laneSamples[lane] *= groupEnvelopes[lane][sample];
+                }
+            }
+
+            if (stereo)
+            {
+                for (int lane = 0; lane < laneWidth; ++lane)
+                {
+                    left[sample] += laneSamples[lane] * groupLeftGains[lane];
+                    right[sample] += laneSamples[lane] * groupRightGains[lane];
+                }
+            }
+            else
+            {
+                left[sample] += ((laneSamples[0] + laneSamples[1]) + (laneSamples[2] + laneSamples[3]))
+                              + ((laneSamples[4] + laneSamples[5]) + (laneSamples[6] + laneSamples[7]));
+            }
+        }
+
+        _mm256_storeu_si256((__m256i*)(set.phases + firstLane), groupPhases);
+        _mm256_storeu_si256((__m256i*)(set.increments + firstLane), groupIncrements);
+    }
+
+   #else
+    /** The per-group state renderLaneSample reads, loaded once per group.
+
+    */
+    struct LaneGroup
+    {
+        __m128i incrementSteps;
+        __m128 scales;
+        __m128 gains;
+        const void* const* tables;
+        const void* const* nextTables;
+        __m128 mixes;
+        __m128 sampleScales;
+        __m128 nextSampleScales;
+    };
+
+    /** Returns one sample from each of four lanes, interpolated and scaled by their gains, and advances their phases and increments.
+
+        Samples are gathered lane by lane, then decoded from format four at a time. When morphing, both frames
+        are interpolated at the same positions, then mixed.
+    */
+    template <WavetableSampleFormat format, bool morphing, typename Kernel>
+    static forcedinline __m128 renderLaneSample(const Kernel& kernel, __m128i& laneGroupPhases, __m128i& laneGroupIncrements, const LaneGroup& group) noexcept
+    {
+        using SampleType = typename WavetableSampleTraits<format>::Type;
+        constexpr bool scaled = format != WavetableSampleFormat::float32;
+
+        // Position in table samples, from the top 24 bits of each phase
+        __m128 position = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(laneGroupPhases, 8)), group.scales);
+        __m128i index = _mm_cvttps_epi32(position);
+        __m128 frac = _mm_sub_ps(position, _mm_cvtepi32_ps(index));
+
+        // Each lane reads its own table, so the loads are assembled lane by lane
+        LaneFrameReader<format> reader { { static_cast<const SampleType*>(group.tables[0]),
+                                           static_cast<const SampleType*>(group.tables[1]),
+                                           static_cast<const SampleType*>(group.tables[2]),
+                                           static_cast<const SampleType*>(group.tables[3]) } };
+
+        __m128 value = kernel.interpolate4(reader, index, frac);
+
+        if (scaled)
+        {
+            value = _mm_mul_ps(value, group.sampleScales);
+        }
+
+        if (morphing)
+        {
+            LaneFrameReader<format> nextReader { { static_cast<const SampleType*>(group.nextTables[0]),
+                                                   static_cast<const SampleType*>(group.nextTables[1]),
+                                                   static_cast<const SampleType*>(group.nextTables[2]),
+                                                   static_cast<const SampleType*>(group.nextTables[3]) } };
+
+            __m128 next = kernel.interpolate4(nextReader, index, frac);
+
+            if (scaled)
+            {
+                next = _mm_mul_ps(next, group.nextSampleScales);
+            }
+
+            value = _mm_add_ps(value, _mm_mul_ps(group.mixes, _mm_sub_ps(next, value)));
+        }
+
+        laneGroupPhases = _mm_add_epi32(laneGroupPhases, laneGroupIncrements);
+        laneGroupIncrements = _mm_add_epi32(laneGroupIncrements, group.incrementSteps);
+
+        return _mm_mul_ps(value, group.gains);
+    }
+
+    /** Adds the sum of four lanes into left, and into right when rendering in stereo.
+
+        Four samples are rendered per step and transposed, so each row holds four consecutive samples
+        of one lane. Rows are then scaled by their lane's envelope and summed vertically. In stereo,
+        the lane gains are applied per row instead, once for each side.
+    */
+    template <WavetableSampleFormat format, bool withEnvelopes, bool stereo, bool morphing, typename Kernel>
+    void renderLaneGroup(const Kernel& kernel, LaneSet& set, int firstLane, float* left, float* right, int numSamples) noexcept
+    {
+        LaneGroup group;
+        group.incrementSteps = _mm_loadu_si128((const __m128i*)(set.incrementSteps + firstLane));
+        group.scales = _mm_loadu_ps(set.scales + firstLane);
+        group.gains = stereo ? _mm_set1_ps(1.0f) : _mm_loadu_ps(set.gains + firstLane);
+        group.tables = set.tables + firstLane;
+        group.nextTables = set.nextTables + firstLane;
+        group.mixes = _mm_loadu_ps(set.frameMixes + firstLane);
+        group.sampleScales = _mm_loadu_ps(set.sampleScales + firstLane);
+        group.nextSampleScales = _mm_loadu_ps(set.nextSampleScales + firstLane);
+
+        __m128i groupPhases = _mm_loadu_si128((const __m128i*)(set.phases + firstLane));
+        __m128i groupIncrements = _mm_loadu_si128((const __m128i*)(set.increments + firstLane));
+        const float* const* groupEnvelopes = set.envelopes + firstLane;
+        const float* groupLeftGains = set.leftGains + firstLane;
+        const float* groupRightGains = set.rightGains + firstLane;
+
+        int sample = 0;
+
+        for (; sample + 4 <= numSamples; sample += 4)
+        {
+            __m128 row0 = renderLaneSample<format, morphing>(kernel, groupPhases, groupIncrements, group);
+            __m128 row1 = renderLaneSample<format, morphing>(kernel, groupPhases, groupIncrements, group);
+            __m128 row2 = renderLaneSample<format, morphing>(kernel, groupPhases, groupIncrements, group);
+            __m128 row3 = renderLaneSample<format, morphing>(kernel, groupPhases, groupIncrements, group);
+
+            // Rows become lanes: each now holds four consecutive samples of one oscillator
+            _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+            if (withEnvelopes)
+            {
+                row0 = _mm_mul_ps(row0, _mm_loadu_ps(groupEnvelopes[0] + sample));
+                row1 = _mm_mul_ps(row1, _mm_loadu_ps(groupEnvelopes[1] + sample));
+                row2 = _mm_mul_ps(row2, _mm_loadu_ps(groupEnvelopes[2] + sample));
+                row3 = _mm_mul_ps(row3, _mm_loadu_ps(groupEnvelopes[3] + sample));
+            }
+
+            if (stereo)
+            {
+                __m128 sumLeft = _mm_add_ps(_mm_add_ps(_mm_mul_ps(row0, _mm_set1_ps(groupLeftGains[0])), _mm_mul_ps(row1, _mm_set1_ps(groupLeftGains[1]))),
+                                            _mm_add_ps(_mm_mul_ps(row2, _mm_set1_ps(groupLeftGains[2])), _mm_mul_ps(row3, _mm_set1_ps(groupLeftGains[3]))));
+                __m128 sumRight = _mm_add_ps(_mm_add_ps(_mm_mul_ps(row0, _mm_set1_ps(groupRightGains[0])), _mm_mul_ps(row1, _mm_set1_ps(groupRightGains[1]))),
+                                             _mm_add_ps(_mm_mul_ps(row2, _mm_set1_ps(groupRightGains[2])), _mm_mul_ps(row3, _mm_set1_ps(groupRightGains[3]))));
+
+                _mm_storeu_ps(left + sample, _mm_add_ps(_mm_loadu_ps(left + sample), sumLeft));
+                _mm_storeu_ps(right + sample, _mm_add_ps(_mm_loadu_ps(right + sample), sumRight));
+            }
+            else
+            {
+                __m128 sum = _mm_add_ps(_mm_add_ps(row0, row1), _mm_add_ps(row2, row3));
+                _mm_storeu_ps(left + sample, _mm_add_ps(_mm_loadu_ps(left + sample), sum));
+            }
+        }
+
+        // Remaining samples, summed across lanes one at a time
+        for (; sample < numSamples; ++sample)
+        {
+            alignas(16) float laneSamples[laneWidth];
+            _mm_store_ps(laneSamples, renderLaneSample<format, morphing>(kernel, groupPhases, groupIncrements, group));
+
+            if (withEnvelopes)
+            {
+                for (int lane = 0; lane < laneWidth; ++lane)
+                {
+                    laneSamples[lane] *= groupEnvelopes[lane][sample];
+                }
+            }
+
+            if (stereo)
+            {
+                for (int lane = 0; lane < laneWidth; ++lane)
+                {
+                    left[sample] += laneSamples[lane] * groupLeftGains[lane];
+                    right[sample] += laneSamples[lane] * groupRightGains[lane];
+                }
+            }
+            else
+            {
+                left[sample] += (laneSamples[0] + laneSamples[1]) + (laneSamples[2] + laneSamples[3]);
+            }
+        }
+
+        _mm_storeu_si128((__m128i*)(set.phases + firstLane), groupPhases);
+        _mm_storeu_si128((__m128i*)(set.increments + firstLane), groupIncrements);
+    }
+   #endif
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OscillatorLanes)
+};
+
+#endif
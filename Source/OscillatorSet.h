@@ -0,0 +1,166 @@
+/*
+  ==============================================================================
+
+    OscillatorSet.h
+    Created: 17 Oct 2026 6:12:37pm
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Common.h"
+#include "ParameterSnapshot.h"
+#include "WavetableCollector.h"
+
+
+/** An immutable list of the oscillators every voice should hold, and the wavetable each one reads.
+
+    Built on the message thread whenever oscillators are added, removed, reordered or change wavetable,
+    and published through an OscillatorSetExchange. Each oscillator keeps the same id for as long as its
+    node is in the tree, so banks can match their oscillators to the set and keep their phases.
+*/
+struct OscillatorSet
+{
+    struct Entry
+    {
+        // Assigned from 1, so 0 never matches an oscillator
+        uint32 id = 0;
+        WavetableHandle wavetable;
+    };
+
+    // Assigned by OscillatorSetExchange::publish. Version 0 is the empty set the exchange starts with
+    uint32 version = 0;
+
+    int numOscillators = 0;
+    std::array<Entry, ParameterSnapshot::maxOscillators> oscillators;
+};
+
+//==================================================================================
+/** Hands OscillatorSets from the message thread to the audio thread with an atomic pointer swap, and frees old ones on a background thread.
+
+    The audio thread acquires the latest set at the start of a block, brings its oscillators in line with it,
+    and then acknowledges the set's version. A replaced set is only deleted once a newer version has been
+    acknowledged. By then the audio thread can't still be reading it, and no oscillator points at a wavetable
+    only it kept alive, so any table it releases here can go straight to the WavetableCollector.
+*/
+class OscillatorSetExchange : private Thread
+{
+public:
+    OscillatorSetExchange()
+        : Thread("Oscillator set reclaimer")
+    {
+        latest.store(new OscillatorSet());
+
+        startThread(1);
+    }
+
+    ~OscillatorSetExchange()
+    {
+        stopThread(1000);
+
+        delete latest.load();
+    }
+
+    //==============================================================================
+    /** Makes newSet the latest set, assigning it the next version. Message thread only.
+
+    */
+    void publish(std::unique_ptr<OscillatorSet> newSet)
+    {
+        newSet->version = ++lastPublishedVersion;
+
+        OscillatorSet* previous = latest.exchange(newSet.release(), std::memory_order_acq_rel);
+
+        {
+            const ScopedLock sl(retiredLock);
+            retired.push_back(std::unique_ptr<OscillatorSet>(previous));
+        }
+
+        notify();
+    }
+
+    /** Returns the version of the last set passed to publish. Message thread only.
+
+    */
+    uint32 getLatestVersion() const noexcept
+    {
+        return lastPublishedVersion;
+    }
+
+    //==============================================================================
+    /** Returns the latest set. Audio thread only.
+
+        The set stays valid until a newer version is passed to acknowledge.
+    */
+    const OscillatorSet& acquire() const noexcept
+    {
+        return *latest.load(std::memory_order_acquire);
+    }
+
+    /** Tells the exchange that the audio thread has finished applying a set, so older sets can be freed.
+
+    */
+    void acknowledge(uint32 version) noexcept
+    {
+        acknowledgedVersion.store(version, std::memory_order_release);
+    }
+
+private:
+    //==============================================================================
+    std::atomic<OscillatorSet*> latest { nullptr };
+    std::atomic<uint32> acknowledgedVersion { 0 };
+
+    // Message thread only
+    uint32 lastPublishedVersion = 0;
+
+    // Replaced sets waiting to be freed. Shared by the message thread and the reclaimer, never the audio thread
+    CriticalSection retiredLock;
+    std::vector<std::unique_ptr<OscillatorSet>> retired;
+
+    // How often the reclaimer checks for sets to free when nothing has been published
+    static constexpr int reclaimIntervalMs = 500;
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            reclaim();
+            wait(reclaimIntervalMs);
+        }
+    }
+
+    /** Frees every retired set older than the last version the audio thread acknowledged.
+
+    */
+    void reclaim()
+    {
+        uint32 acknowledged = acknowledgedVersion.load(std::memory_order_acquire);
+
+        std::vector<std::unique_ptr<OscillatorSet>> toFree;
+
+        {
+            const ScopedLock sl(retiredLock);
+
+            for (auto it = retired.begin(); it != retired.end();)
+            {
+                if ((*it)->version < acknowledged)
+                {
+                    toFree.push_back(std::move(*it));
+                    it = retired.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+
+        // Sets are freed here outside the lock, retiring any wavetables only they still held
+    }
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OscillatorSetExchange)
+};
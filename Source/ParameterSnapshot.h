@@ -0,0 +1,327 @@
+/*
+  ==============================================================================
+
+    ParameterSnapshot.h
+    Created: 17 Oct 2026 10:12:04am
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Common.h"
+#include "WavetableInterpolation.h"
+#include "BlockEnvelope.h"
+#include "VoiceAllocator.h"
+
+
+/** How a voice handles being stolen while it is still playing a note. Compiled from IDs::voiceStealMode.
+
+*/
+enum class VoiceStealMode
+{
+    normal,
+    portamento,
+    legato
+};
+
+/** How the synth renders its voices. Compiled from IDs::renderMode.
+
+    automatic renders voices in parallel when bouncing offline, and interleaved otherwise.
+*/
+enum class VoiceRenderSetting
+{
+    automatic,
+    serial,
+    interleaved,
+    parallel
+};
+
+//==================================================================================
+/** The parameters of a single oscillator, as read by the audio thread.
+
+*/
+struct OscillatorSnapshot
+{
+    bool enabled = true;
+
+    // -1 (left) to 1 (right)
+    float pan = 0.0f;
+
+    // 0 (first frame) to 1 (last frame) of a multi-frame table
+    float framePosition = 0.0f;
+
+    int detuneOctave = 0;
+    int detuneCoarse = 0;
+    int detuneFine = 0;
+};
+
+//==================================================================================
+/** A plain copy of everything in the PARAMETERS tree that the audio thread needs.
+
+    Snapshots are built on the message thread whenever the tree changes and handed to
+    the audio thread through a SnapshotExchange, so rendering never has to look up an
+    Identifier, compare a var or touch a ValueTree's reference count.
+*/
+struct ParameterSnapshot
+{
+    // The most oscillators a single manager can hold
+    static constexpr int maxOscillators = 16;
+
+    // Incremented each time a snapshot is published, so readers can cheaply tell when something changed
+    uint32 version = 0;
+
+    // ==========================
+    // ====== OSC MANAGER =======
+    // ==========================
+    bool managerEnabled = true;
+    VoiceStealMode voiceStealMode = VoiceStealMode::normal;
+    VoiceStealPolicy voiceStealPolicy = VoiceStealPolicy::oldest;
+    InterpolationMode interpolation = InterpolationMode::linear;
+
+    // Semitones either way at full deflection of the pitch wheel
+    int pitchBendRange = 2;
+
+    // A falling note whose envelope and output stay below silenceFloor, as a gain, for silenceTime seconds in a row
+    // has its voice retired early. 0 seconds turns this off
+    float silenceFloor = Decibels::decibelsToGain(-96.0f);
+    float silenceTime = 0.05f;
+
+    // Applied by prepareToPlay rather than every block, as changing the number of render threads starts and stops them.
+    // -1 threads uses every core but one
+    VoiceRenderSetting renderMode = VoiceRenderSetting::automatic;
+    int numRenderThreads = -1;
+
+    // Listed in the order of the OscillatorSet with this version, which is set by the processor when publishing
+    uint32 oscillatorSetVersion = 0;
+    int numOscillators = 0;
+    OscillatorSnapshot oscillators[maxOscillators];
+
+    // =======================
+    // ====== ENVELOPES ======
+    // =======================
+    bool hasGainEnvelope = false;
+    BlockEnvelope::Parameters gainEnvelope;
+
+    bool hasFilterEnvelope = false;
+    BlockEnvelope::Parameters filterEnvelope;
+
+    //==============================================================================
+    /** Compiles a snapshot from the main PARAMETERS tree. Message thread only.
+
+    */
+    static ParameterSnapshot fromTree(const ValueTree& parameters)
+    {
+        ParameterSnapshot snapshot;
+
+        ValueTree oscMgr = parameters.getChildWithName(IDs::OSC_MGR);
+
+        snapshot.managerEnabled = oscMgr.getProperty(IDs::enabled);
+        snapshot.voiceStealMode = voiceStealModeFromVar(oscMgr.getProperty(IDs::voiceStealMode));
+        snapshot.voiceStealPolicy = voiceStealPolicyFromVar(oscMgr.getProperty(IDs::voiceStealPolicy));
+        snapshot.interpolation = interpolationModeFromVar(oscMgr.getProperty(IDs::interpolation));
+        snapshot.pitchBendRange = jlimit(0, 48, (int)oscMgr.getProperty(IDs::pitchBendRange, 2));
+        snapshot.silenceFloor = Decibels::decibelsToGain(jlimit(-160.0f, 0.0f, (float)oscMgr.getProperty(IDs::silenceFloor, -96.0f)), -160.0f);
+        snapshot.silenceTime = jmax(0.0f, (float)oscMgr.getProperty(IDs::silenceTime, 0.05f));
+        snapshot.renderMode = voiceRenderSettingFromVar(oscMgr.getProperty(IDs::renderMode));
+        snapshot.numRenderThreads = jmax(-1, (int)oscMgr.getProperty(IDs::renderThreads, -1));
+
+        // Oscillators
+        ValueTree oscGroup = oscMgr.getChildWithName(IDs::OSC_GROUP);
+        jassert(oscGroup.getNumChildren() <= maxOscillators);
+
+        snapshot.numOscillators = jmin(oscGroup.getNumChildren(), maxOscillators);
+
+        for (int i = 0; i < snapshot.numOscillators; ++i)
+        {
+            ValueTree osc = oscGroup.getChild(i);
+            ValueTree detune = osc.getChildWithName(IDs::DETUNE);
+
+            OscillatorSnapshot& oscSnapshot = snapshot.oscillators[i];
+            oscSnapshot.enabled = osc.getProperty(IDs::enabled);
+            oscSnapshot.pan = jlimit(-1.0f, 1.0f, (float)osc.getProperty(IDs::pan, 0.0f));
+            oscSnapshot.framePosition = jlimit(0.0f, 1.0f, (float)osc.getProperty(IDs::framePosition, 0.0f));
+            oscSnapshot.detuneOctave = detune.getProperty(IDs::detuneOctave);
+            oscSnapshot.detuneCoarse = detune.getProperty(IDs::detuneCoarse);
+            oscSnapshot.detuneFine = detune.getProperty(IDs::detuneFine);
+        }
+
+        // Envelopes
+        ValueTree gainEnv = oscMgr.getChildWithProperty(IDs::target, "GAIN");
+        snapshot.hasGainEnvelope = gainEnv.isValid();
+        if (snapshot.hasGainEnvelope)
+        {
+            snapshot.gainEnvelope = envelopeFromTree(gainEnv);
+        }
+
+        ValueTree filterEnv = oscMgr.getChildWithProperty(IDs::target, "FILTER");
+        snapshot.hasFilterEnvelope = filterEnv.isValid();
+        if (snapshot.hasFilterEnvelope)
+        {
+            snapshot.filterEnvelope = envelopeFromTree(filterEnv);
+        }
+
+        return snapshot;
+    }
+
+    /** Converts the string stored under IDs::voiceStealMode.
+
+    */
+    static VoiceStealMode voiceStealModeFromVar(const var& mode)
+    {
+        if (mode == "PORTAMENTO")
+        {
+            return VoiceStealMode::portamento;
+        }
+        else if (mode == "LEGATO")
+        {
+            return VoiceStealMode::legato;
+        }
+
+        return VoiceStealMode::normal;
+    }
+
+    /** Converts the string stored under IDs::voiceStealPolicy. Anything unrecognised steals the oldest voice.
+
+    */
+    static VoiceStealPolicy voiceStealPolicyFromVar(const var& policy)
+    {
+        if (policy == "QUIETEST")
+        {
+            return VoiceStealPolicy::quietest;
+        }
+        else if (policy == "PROTECT_LOWEST")
+        {
+            return VoiceStealPolicy::lowestNoteProtected;
+        }
+
+        return VoiceStealPolicy::oldest;
+    }
+
+    /** Converts the string stored under IDs::renderMode. Anything unrecognised picks automatically.
+
+    */
+    static VoiceRenderSetting voiceRenderSettingFromVar(const var& mode)
+    {
+        if (mode == "SERIAL")
+        {
+            return VoiceRenderSetting::serial;
+        }
+        else if (mode == "INTERLEAVED")
+        {
+            return VoiceRenderSetting::interleaved;
+        }
+        else if (mode == "PARALLEL")
+        {
+            return VoiceRenderSetting::parallel;
+        }
+
+        return VoiceRenderSetting::automatic;
+    }
+
+    /** Converts the string stored under IDs::interpolation. Anything unrecognised reads linearly.
+
+    */
+    static InterpolationMode interpolationModeFromVar(const var& mode)
+    {
+        if (mode == "NEAREST")
+        {
+            return InterpolationMode::nearest;
+        }
+        else if (mode == "HERMITE")
+        {
+            return InterpolationMode::hermite;
+        }
+        else if (mode == "SINC")
+        {
+            return InterpolationMode::sinc;
+        }
+
+        return InterpolationMode::linear;
+    }
+
+    /** Reads ADSR parameters from an ENVELOPE node. Decays and releases are linear unless its curve is EXPONENTIAL.
+
+    */
+    static BlockEnvelope::Parameters envelopeFromTree(const ValueTree& envelope)
+    {
+        BlockEnvelope::Parameters envParameters;
+
+        envParameters.attack = envelope.getProperty(IDs::attack);
+        envParameters.decay = envelope.getProperty(IDs::decay);
+        envParameters.sustain = envelope.getProperty(IDs::sustain);
+        envParameters.release = envelope.getProperty(IDs::release);
+        envParameters.curve = envelope.getProperty(IDs::curve) == "EXPONENTIAL" ? BlockEnvelope::Curve::exponential
+                                                                              : BlockEnvelope::Curve::linear;
+
+        return envParameters;
+    }
+};
+
+//==================================================================================
+/** Passes snapshots from a single writer thread to a single reader thread without locking.
+
+    A triple buffer: the writer fills its back slot and swaps it with the shared middle slot,
+    and the reader swaps the middle slot into its front slot when a new one is waiting.
+    Neither side ever blocks or allocates, and the reader's slot is never written while held.
+*/
+template <typename SnapshotType>
+class SnapshotExchange
+{
+public:
+    SnapshotExchange() = default;
+
+    /** Copies a new snapshot into the writer's slot and makes it available to the reader. Writer thread only.
+
+    */
+    void publish(const SnapshotType& newSnapshot)
+    {
+        slots[backIndex] = newSnapshot;
+
+        int previousMiddle = middle.exchange(backIndex | freshFlag, std::memory_order_acq_rel);
+        backIndex = previousMiddle & indexMask;
+    }
+
+    /** Picks up the latest published snapshot, if there is one, and returns it. Reader thread only.
+
+        The returned reference stays valid and unchanged until the next call to acquire.
+    */
+    const SnapshotType& acquire() noexcept
+    {
+        if ((middle.load(std::memory_order_relaxed) & freshFlag) != 0)
+        {
+            int previousMiddle = middle.exchange(frontIndex, std::memory_order_acq_rel);
+            frontIndex = previousMiddle & indexMask;
+        }
+
+        return slots[frontIndex];
+    }
+
+    /** Returns the snapshot picked up by the last call to acquire. Reader thread only.
+
+    */
+    const SnapshotType& getCurrent() const noexcept
+    {
+        return slots[frontIndex];
+    }
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int freshFlag = 4;
+
+    SnapshotType slots[3];
+
+    // Index of the shared slot, with freshFlag set if the writer has put something new there
+    std::atomic<int> middle { 1 };
+
+    // Owned by the writer
+    int backIndex = 2;
+
+    // Owned by the reader
+    int frontIndex = 0;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE(SnapshotExchange)
+};
@@ -0,0 +1,182 @@
+/*
+  ==============================================================================
+
+    PhaseAccumulator.h
+    Created: 17 Oct 2026 12:20:51pm
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Common.h"
+
+
+/** The original phase engine: a float index in table samples, wrapped by subtracting the table size.
+
+    Precision falls as the index grows, so large tables and long notes drift in pitch.
+    Kept for comparison against FixedPointPhase.
+*/
+struct FloatPhase
+{
+    /** Sets the size of the table being read, rescaling the index so the position in the cycle is kept.
+
+        Must be called before setIncrement, as the increment is measured in table samples.
+    */
+    void setTableSize(int newTableSize) noexcept
+    {
+        float newSize = (float)newTableSize;
+
+        if (size > 0.0f && newSize != size)
+        {
+            index *= newSize / size;
+            index -= (index >= newSize) ? newSize : 0.0f;
+        }
+
+        size = newSize;
+    }
+
+    /** Sets the step per sample, in cycles of the table, ending any ramp. 0 stops the oscillator.
+
+    */
+    void setIncrement(double cyclesPerSample) noexcept
+    {
+        increment = (float)(cyclesPerSample * (double)size);
+        incrementStep = 0.0f;
+    }
+
+    /** Ramps the step linearly from where it is to cyclesPerSample over the next numSamples.
+
+        Call setIncrement with the same value once they've been rendered, to hold it there.
+    */
+    void rampIncrement(double cyclesPerSample, int numSamples) noexcept
+    {
+        jassert(numSamples > 0);
+        incrementStep = ((float)(cyclesPerSample * (double)size) - increment) / (float)numSamples;
+    }
+
+    bool hasIncrement() const noexcept                  { return increment != 0.0f; }
+    void reset() noexcept                               { index = 0.0f; }
+
+    /** Returns the position within the cycle, from 0 to 1.
+
+    */
+    double getCyclePosition() const noexcept            { return size > 0.0f ? (double)index / (double)size : 0.0; }
+    void setCyclePosition(double position) noexcept     { index = (float)(position * (double)size); }
+
+    // ============================
+    // ====== PER-SAMPLE USE ======
+    // ============================
+    forcedinline int getIndex() const noexcept          { return (int)index; }
+    forcedinline float getFraction() const noexcept     { return index - (float)(int)index; }
+
+    forcedinline void advance() noexcept
+    {
+        // Wrap without a branch; tables hold one guard sample at size
+        index += increment;
+        index -= (index >= size) ? size : 0.0f;
+        increment += incrementStep;
+    }
+
+    float index = 0.0f;
+    float increment = 0.0f;
+    float incrementStep = 0.0f;
+    float size = 0.0f;
+};
+
+//==================================================================================
+/** A 32-bit fixed-point phase engine for power-of-two tables.
+
+    One full cycle is 2^32. The top log2(tableSize) bits of the phase index the table and the
+    remaining bits are the interpolation fraction, so wraparound is just integer overflow and the
+    position in the cycle is exact however long the note lasts. Because the phase doesn't depend
+    on the table size, switching mip levels needs no rescaling.
+*/
+struct FixedPointPhase
+{
+    /** Sets the size of the table being read, which must be a power of two of at least 2.
+
+    */
+    void setTableSize(int newTableSize) noexcept
+    {
+        jassert(isPowerOfTwo(newTableSize) && newTableSize >= 2);
+
+        int tableBits = 0;
+        while ((1 << tableBits) < newTableSize)
+        {
+            ++tableBits;
+        }
+
+        indexShift = 32 - tableBits;
+        fractionMask = ((uint32)1 << indexShift) - 1;
+        fractionScale = (float)(1.0 / std::ldexp(1.0, indexShift));
+    }
+
+    /** Sets the step per sample, in cycles of the table, ending any ramp. 0 stops the oscillator.
+
+    */
+    void setIncrement(double cyclesPerSample) noexcept
+    {
+        increment = toFixedPoint(cyclesPerSample);
+        incrementStep = 0;
+    }
+
+    /** Ramps the step linearly from where it is to cyclesPerSample over the next numSamples.
+
+        The step is added modulo 2^32 like the phase, so ramping down needs no sign. Call setIncrement
+        with the same value once they've been rendered, to hold it there.
+    */
+    void rampIncrement(double cyclesPerSample, int numSamples) noexcept
+    {
+        jassert(numSamples > 0);
+
+        int64 change = (int64)toFixedPoint(cyclesPerSample) - (int64)increment;
+        incrementStep = (uint32)(int32)(change / numSamples);
+    }
+
+    bool hasIncrement() const noexcept                  { return increment != 0; }
+    void reset() noexcept                               { phase = 0; }
+
+    /** Returns the position within the cycle, from 0 to 1.
+
+    */
+    double getCyclePosition() const noexcept            { return (double)phase / 4294967296.0; }
+    void setCyclePosition(double position) noexcept     { phase = (uint32)(uint64)(position * 4294967296.0); }
+
+    // ============================
+    // ====== PER-SAMPLE USE ======
+    // ============================
+    forcedinline int getIndex() const noexcept          { return (int)(phase >> indexShift); }
+    forcedinline float getFraction() const noexcept     { return (float)(phase & fractionMask) * fractionScale; }
+
+    forcedinline void advance() noexcept
+    {
+        // Wraps by overflow
+        phase += increment;
+        increment += incrementStep;
+    }
+
+    uint32 phase = 0;
+    uint32 increment = 0;
+    uint32 incrementStep = 0;
+
+    int indexShift = 31;
+    uint32 fractionMask = 0x7fffffffu;
+    float fractionScale = 0.0f;
+
+    static uint32 toFixedPoint(double cyclesPerSample) noexcept
+    {
+        double cycles = cyclesPerSample - std::floor(cyclesPerSample);
+        return (uint32)(uint64)std::llround(cycles * 4294967296.0);
+    }
+};
+
+//==================================================================================
+// The phase engine used by WavetableOscillator, chosen by SYNTHFRAMEWORK_FIXED_POINT_PHASE
+#if SYNTHFRAMEWORK_FIXED_POINT_PHASE
+ using OscillatorPhase = FixedPointPhase;
+#else
+ using OscillatorPhase = FloatPhase;
+#endif
@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+    PitchTable.h
+    Created: 18 Oct 2026 4:12:37am
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+
+/** Converts notes and pitch offsets to phase increments without calling pow on the audio thread.
+
+    Every note's increment, in cycles per sample, is worked out once for the sample rate by setSampleRate.
+    Offsets in cents, such as fine detune and pitch bend, become a multiplier through getCentsRatio, so
+    bending any number of oscillators costs one lookup per voice and a multiply per oscillator.
+*/
+class PitchTable
+{
+public:
+    // Notes with an increment of their own. Octave and coarse detune can take a note beyond the midi range,
+    // so the table reaches five octaves either side of it; notes beyond that play its ends
+    static constexpr int lowestNote = -64;
+    static constexpr int numNotes = 256;
+
+    // Steps of the cents table. Offsets between steps are interpolated
+    static constexpr int centsPerOctave = 1200;
+
+    PitchTable() = default;
+
+    //==============================================================================
+    /** Works out every note's increment at sampleRate. Not for use on the audio thread while the table is being read.
+
+    */
+    void setSampleRate(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+
+        for (int i = 0; i < numNotes; ++i)
+        {
+            noteIncrements[(size_t)i] = sampleRate > 0.0 ? MidiMessage::getMidiNoteInHertz(lowestNote + i) / sampleRate : 0.0;
+        }
+
+        // Built here, before playback, so the audio thread never builds it
+        getCentsRatios();
+    }
+
+    double getSampleRate() const noexcept
+    {
+        return sampleRate;
+    }
+
+    /** Returns the cycles per sample of a midi note at the sample rate, or 0 if no sample rate has been set.
+
+    */
+    double getNoteIncrement(int note) const noexcept
+    {
+        return noteIncrements[(size_t)jlimit(0, numNotes - 1, note - lowestNote)];
+    }
+
+    /** Returns the frequency ratio of an offset in cents: 2^(cents / 1200).
+
+        Whole octaves are exact. The rest is read from a table of single cents and interpolated, which is
+        within a few parts in 10^8 of pow.
+    */
+    static double getCentsRatio(double cents) noexcept
+    {
+        double octaves = std::floor(cents * (1.0 / centsPerOctave));
+        double position = cents - octaves * centsPerOctave;
+
+        int index = jmin((int)position, centsPerOctave - 1);
+        double frac = position - index;
+
+        const auto& ratios = getCentsRatios();
+        double ratio = ratios[(size_t)index] + frac * (ratios[(size_t)index + 1] - ratios[(size_t)index]);
+
+        return std::ldexp(ratio, (int)octaves);
+    }
+
+private:
+    double sampleRate = 0.0;
+    std::array<double, numNotes> noteIncrements {};
+
+    // 2^(cents / 1200) for each cent of one octave, ending with 2
+    static const std::array<double, centsPerOctave + 1>& getCentsRatios()
+    {
+        static const std::array<double, centsPerOctave + 1> ratios = []
+        {
+            std::array<double, centsPerOctave + 1> table;
+
+            for (int i = 0; i <= centsPerOctave; ++i)
+            {
+                table[(size_t)i] = std::pow(2.0, (double)i / centsPerOctave);
+            }
+
+            return table;
+        }();
+
+        return ratios;
+    }
+};
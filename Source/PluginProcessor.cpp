@@ -13,6 +13,8 @@
 #include "SynthVoice.h"
 #include "SynthSound.h"
 #include "WavetableCreator.h"
+#include "WavetableCache.h"
+#include "CompiledWavetables.h"
 
 //==============================================================================
 SynthFrameworkAudioProcessor::SynthFrameworkAudioProcessor()
@@ -27,21 +29,56 @@ SynthFrameworkAudioProcessor::SynthFrameworkAudioProcessor()
                        )
 #endif
 {
+    // Register before any oscillator can be given a wavetable
+    wavetableReader = wavetableCollector->registerReader();
+
     // Create wavetables that can be used by oscillators
     initBaseWavetables(wavetableSize);
 
+    // Index the wavetable library, which is only loaded from as tables are used
+    wavetableLibrary.addDirectory(File::getSpecialLocation(File::userApplicationDataDirectory)
+                                      .getChildFile("SynthFramework")
+                                      .getChildFile("Wavetables"));
+    wavetableLibrary.onTableLoaded = [this] (int tableId)
+    {
+        // A table that has just loaded may be a newer copy of one that oscillators are still playing
+        String name = wavetableLibrary.getTableName(tableId);
+
+        for (PublishedOscillator& published : publishedOscillators)
+        {
+            if (published.waveType == name)
+            {
+                published.wavetable = nullptr;
+            }
+        }
+
+        publishOscillatorSet();
+        finishImports(tableId, {});
+    };
+    wavetableLibrary.onTableFailed = [this] (int tableId, const String& error)
+    {
+        // Its oscillators carry on with the sine
+        if (!finishImports(tableId, error) && onWavetableError)
+        {
+            onWavetableError("Couldn't load wavetable " + wavetableLibrary.getTableName(tableId) + ": " + error);
+        }
+    };
+
     // Create and initialise the main PARAMETER tree 
     initValueTrees();
 
-    // Parameters used to initialise each Voice
-    ValueTree& oscMgrParams = PARAMETERS.getChildWithName(IDs::OSC_MGR);
+    // Keep the audio thread's snapshot in step with the tree
+    PARAMETERS.addListener(this);
+
     // Grab polyphony setting from tree
     numVoices = PARAMETERS.getChild(0).getProperty(IDs::polyphony);
 
+    mySynth.setFadePool(&fadePool);
+
     mySynth.clearVoices();
     for (int i = 0; i < numVoices; ++i)
     {
-        mySynth.addVoice(new SynthVoice(oscMgrParams, *this));
+        mySynth.addVoice(new SynthVoice(*this));
     }
 
     // Manually set some gain envelope parameters
@@ -53,18 +90,22 @@ SynthFrameworkAudioProcessor::SynthFrameworkAudioProcessor()
 
     
     mySynth.clearSounds();
-    mySynth.addSound(new SynthSound(SineTable));
+    mySynth.addSound(new SynthSound(wavetableRegistry->find(IDs::SINE)));
 
     // Add an oscillator
     TREE_addOscillatorNode("SINE");
+
+    publishParameterSnapshot();
 }
 
 SynthFrameworkAudioProcessor::~SynthFrameworkAudioProcessor()
 {
+    PARAMETERS.removeListener(this);
+
     mySynth.clearVoices();
     mySynth.clearSounds();
 
-    clearWavetables();
+    wavetableCollector->unregisterReader(wavetableReader);
 }
 
 //==============================================================================
@@ -134,7 +175,43 @@ void SynthFrameworkAudioProcessor::prepareToPlay (double sampleRate, int samples
 {
     lastSampleRate = sampleRate;
 
-    mySynth.setCurrentPlaybackSampleRate(lastSampleRate);
+    // Tuned before the voices, which read it as they're prepared
+    pitchTable.setSampleRate(lastSampleRate);
+
+    // Sized before the synth, whose lanes make room for every fade slot
+    fadePool.prepareToPlay(samplesPerBlock);
+
+    // Sets the sample rate and sizes the scratch buffers for block rendering
+    mySynth.prepareToPlay(lastSampleRate, samplesPerBlock);
+
+    // Voices pick up oscillators added before playback here
+    applyOscillatorSet();
+
+    // Nothing is rendering yet, so this thread can stand in for the audio thread as the snapshots' reader
+    const ParameterSnapshot& settings = parameterSnapshots.acquire();
+
+    // Offline bounces have no deadline to share the CPU with, so by default they spread dense voices across every core
+    VoiceRenderSetting renderMode = settings.renderMode;
+
+    if (renderMode == VoiceRenderSetting::automatic)
+    {
+        renderMode = isNonRealtime() ? VoiceRenderSetting::parallel : VoiceRenderSetting::interleaved;
+    }
+
+    if (renderMode == VoiceRenderSetting::parallel)
+    {
+        int numThreads = settings.numRenderThreads >= 0 ? settings.numRenderThreads : SystemStats::getNumCpus() - 1;
+
+        mySynth.setNumRenderThreads(numThreads);
+        mySynth.setVoiceRenderMode(WavetableSynthesiser::VoiceRenderMode::parallel);
+    }
+    else
+    {
+        // Workers would only sit idle
+        mySynth.setNumRenderThreads(0);
+        mySynth.setVoiceRenderMode(renderMode == VoiceRenderSetting::serial ? WavetableSynthesiser::VoiceRenderMode::serial
+                                                                            : WavetableSynthesiser::VoiceRenderMode::interleaved);
+    }
 }
 
 void SynthFrameworkAudioProcessor::releaseResources()
@@ -173,6 +250,13 @@ void SynthFrameworkAudioProcessor::processBlock (AudioBuffer<float>& buffer, Mid
     // TODO change if implementing audio-input channels
     buffer.clear();
 
+    // Everything below may read wavetables, including on the render pool's threads, which only run inside this call
+    WavetableCollector::ScopedReader scopedReader(*wavetableCollector, wavetableReader);
+
+    // Pick up any oscillator and parameter changes made since the last block
+    parameterSnapshots.acquire();
+    applyOscillatorSet();
+    mySynth.setVoiceStealPolicy(getParameterSnapshot().voiceStealPolicy);
 
     // calls on synth to render a full block of multi-channel audio with the current voices and sounds given the midi input
     mySynth.renderNextBlock(buffer, midiMessages, 0, buffer.getNumSamples());
@@ -210,11 +294,13 @@ void SynthFrameworkAudioProcessor::TREE_addOscillatorNode(var waveTypeToUse)
     ValueTree oscGroup = PARAMETERS.getChildWithName(IDs::OSC_MGR).getChildWithName(IDs::OSC_GROUP);
     int numOsc = oscGroup.getNumChildren();
 
+    // The audio thread only has room for a fixed number of oscillators
+    jassert(numOsc < ParameterSnapshot::maxOscillators);
+
     ValueTree newOsc = OscillatorParameters.createCopy();
     newOsc.setProperty(IDs::waveType, waveTypeToUse, nullptr);
 
-    // Add node to the oscillator group, which should trigger the listeners in
-    // oscillatorManager objects and create a new oscillator
+    // Add node to the oscillator group, which triggers the processor's listener to publish a new oscillator set
     oscGroup.addChild(newOsc, numOsc, nullptr);
 }
 
@@ -229,47 +315,276 @@ void SynthFrameworkAudioProcessor::TREE_removeOscillatorNode(int index)
     oscGroup.removeChild(oscGroup.getChild(index), nullptr);
 }
 
-std::shared_ptr<AudioBuffer<float>> SynthFrameworkAudioProcessor::getWavetablePtrFromType(var waveType)
+WavetableHandle SynthFrameworkAudioProcessor::getWavetablePtrFromType(var waveType)
 {
-    if (waveType == "SINE")
+    String typeName = waveType.toString();
+
+    if (typeName.isEmpty())
     {
-        return SineTable;
+        return nullptr;
     }
-    else if (waveType == "SAW")
+
+    // Identifiers are interned, so the registry matches them by pointer
+    if (WavetableHandle table = wavetableRegistry->find(Identifier(typeName)))
     {
-        return SawTable;
+        return table;
     }
-    else if (waveType == "RAMP")
+
+    int tableId = wavetableLibrary.getTableId(typeName);
+
+    if (tableId < 0)
     {
-        return RampTable;
+        return nullptr;
     }
-    else if (waveType == "TRIANGLE")
+
+    WavetableHandle table = wavetableLibrary.getIfResident(tableId);
+
+    // Loading could take a while, so load in the background and republish once it's done
+    if (table == nullptr)
     {
-        return TriangleTable;
+        wavetableLibrary.prefetch(tableId);
     }
-    else if (waveType == "SQUARE")
+
+    return table;
+}
+
+void SynthFrameworkAudioProcessor::prefetchWavetables(const StringArray& waveTypes)
+{
+    for (const String& waveType : waveTypes)
     {
-        return SquareTable;
+        int tableId = wavetableLibrary.getTableId(waveType);
+
+        if (tableId >= 0)
+        {
+            wavetableLibrary.prefetch(tableId);
+        }
     }
 }
 
-void SynthFrameworkAudioProcessor::initBaseWavetables(int tableSize)
+void SynthFrameworkAudioProcessor::importWavetable(const File& file, std::function<void(const String& error)> onFinished)
+{
+    int tableId = wavetableLibrary.addFile(file);
+
+    pendingImports.emplace_back(tableId, std::move(onFinished));
+    wavetableLibrary.prefetch(tableId);
+}
+
+bool SynthFrameworkAudioProcessor::finishImports(int tableId, const String& error)
+{
+    // Taken out of the queue first, so a callback can start another import
+    std::vector<std::function<void(const String& error)>> finished;
+
+    for (auto it = pendingImports.begin(); it != pendingImports.end();)
+    {
+        if (it->first == tableId)
+        {
+            finished.push_back(std::move(it->second));
+            it = pendingImports.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    for (auto& onFinished : finished)
+    {
+        if (onFinished)
+        {
+            onFinished(error);
+        }
+        else if (error.isNotEmpty() && onWavetableError)
+        {
+            onWavetableError("Couldn't import " + wavetableLibrary.getTableName(tableId) + ": " + error);
+        }
+    }
+
+    return !finished.empty();
+}
+
+//==============================================================================
+const ParameterSnapshot& SynthFrameworkAudioProcessor::getParameterSnapshot() const noexcept
+{
+    return parameterSnapshots.getCurrent();
+}
+
+const PitchTable& SynthFrameworkAudioProcessor::getPitchTable() const noexcept
+{
+    return pitchTable;
+}
+
+FadePool& SynthFrameworkAudioProcessor::getFadePool() noexcept
 {
-    // Store wavetables in shared_ptrs
-    SineTable = WavetableCreator::createSineTable(wavetableSize);
-    SawTable = WavetableCreator::createSawTable(wavetableSize);
-    RampTable = WavetableCreator::createRampTable(wavetableSize);
-    TriangleTable = WavetableCreator::createTriangleTable(wavetableSize);
-    SquareTable = WavetableCreator::createSquareTable(wavetableSize);
+    return fadePool;
 }
 
-void SynthFrameworkAudioProcessor::clearWavetables()
+void SynthFrameworkAudioProcessor::countVoiceRetirement() noexcept
 {
-    SineTable.reset();
-    SawTable.reset();
-    RampTable.reset();
-    TriangleTable.reset();
-    SquareTable.reset();
+    numVoiceRetirements.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint32 SynthFrameworkAudioProcessor::getNumVoiceRetirements() const noexcept
+{
+    return numVoiceRetirements.load(std::memory_order_relaxed);
+}
+
+void SynthFrameworkAudioProcessor::publishParameterSnapshot()
+{
+    ParameterSnapshot snapshot = ParameterSnapshot::fromTree(PARAMETERS);
+    snapshot.version = ++parameterSnapshotVersion;
+    snapshot.interpolation = jmin(snapshot.interpolation, maximumInterpolation);
+    snapshot.oscillatorSetVersion = oscillatorSets.getLatestVersion();
+
+    parameterSnapshots.publish(snapshot);
+}
+
+void SynthFrameworkAudioProcessor::setMaximumInterpolation(InterpolationMode newMaximum)
+{
+    if (newMaximum != maximumInterpolation)
+    {
+        maximumInterpolation = newMaximum;
+        publishParameterSnapshot();
+    }
+}
+
+void SynthFrameworkAudioProcessor::publishOscillatorSet()
+{
+    ValueTree oscGroup = PARAMETERS.getChildWithName(IDs::OSC_MGR).getChildWithName(IDs::OSC_GROUP);
+
+    auto newSet = std::make_unique<OscillatorSet>();
+    newSet->numOscillators = jmin(oscGroup.getNumChildren(), ParameterSnapshot::maxOscillators);
+
+    std::vector<PublishedOscillator> newOscillators;
+
+    for (int i = 0; i < newSet->numOscillators; ++i)
+    {
+        ValueTree osc = oscGroup.getChild(i);
+        String waveType = osc[IDs::waveType].toString();
+
+        // Nodes already in the set keep their id, so voices keep their oscillators' phases
+        auto existing = std::find_if(publishedOscillators.begin(), publishedOscillators.end(),
+                                     [&osc](const PublishedOscillator& published) { return published.node == osc; });
+        uint32 id = (existing != publishedOscillators.end()) ? existing->id : ++lastOscillatorId;
+
+        // An oscillator whose waveType hasn't changed keeps the table it's playing, even if the library has
+        // since dropped its own copy, rather than going back to the sine while it's loaded again
+        WavetableHandle wavetable;
+
+        if (existing != publishedOscillators.end() && existing->wavetable != nullptr && existing->waveType == waveType)
+        {
+            wavetable = existing->wavetable;
+        }
+        else
+        {
+            wavetable = getWavetablePtrFromType(waveType);
+        }
+
+        newOscillators.push_back({ osc, id, waveType, wavetable });
+
+        // Oscillators can't play without a table, so fall back to a sine for unknown wave types,
+        // and for library tables until they've loaded
+        jassert(wavetable != nullptr || wavetableLibrary.getTableId(waveType) >= 0);
+        if (wavetable == nullptr)
+        {
+            wavetable = wavetableRegistry->find(IDs::SINE);
+        }
+
+        newSet->oscillators[i].id = id;
+        newSet->oscillators[i].wavetable = wavetable;
+    }
+
+    publishedOscillators = std::move(newOscillators);
+
+    oscillatorSets.publish(std::move(newSet));
+}
+
+void SynthFrameworkAudioProcessor::applyOscillatorSet()
+{
+    const OscillatorSet& set = oscillatorSets.acquire();
+
+    mySynth.applyOscillatorSet(set);
+
+    // The set being replaced, and any wavetables only it held, can now be freed
+    oscillatorSets.acknowledge(set.version);
+}
+
+void SynthFrameworkAudioProcessor::valueTreePropertyChanged(ValueTree& treeWhosePropertyHasChanged, const Identifier& property)
+{
+    if (property == IDs::waveType)
+    {
+        publishOscillatorSet();
+    }
+
+    publishParameterSnapshot();
+}
+
+void SynthFrameworkAudioProcessor::valueTreeChildAdded(ValueTree& parentTree, ValueTree& childWhichHasBeenAdded)
+{
+    if (parentTree.hasType(IDs::OSC_GROUP))
+    {
+        publishOscillatorSet();
+    }
+
+    publishParameterSnapshot();
+}
+
+void SynthFrameworkAudioProcessor::valueTreeChildRemoved(ValueTree& parentTree, ValueTree& childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved)
+{
+    if (parentTree.hasType(IDs::OSC_GROUP))
+    {
+        publishOscillatorSet();
+    }
+
+    publishParameterSnapshot();
+}
+
+void SynthFrameworkAudioProcessor::valueTreeChildOrderChanged(ValueTree& parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex)
+{
+    if (parentTreeWhoseChildrenHaveMoved.hasType(IDs::OSC_GROUP))
+    {
+        publishOscillatorSet();
+    }
+
+    publishParameterSnapshot();
+}
+
+void SynthFrameworkAudioProcessor::initBaseWavetables(int tableSize)
+{
+    // Only the first instance in the process gets as far as loading or generating anything
+    wavetableRegistry->findOrCreate({ IDs::SINE, IDs::SAW, IDs::RAMP, IDs::TRIANGLE, IDs::SQUARE }, [tableSize]
+    {
+        // Sizes built into the plugin are read in place from its read-only data, with nothing to load or generate
+        if (CompiledWavetables::isCompiled(tableSize))
+        {
+            return CompiledWavetables::createTables(tableSize);
+        }
+
+        std::vector<WavetableCreator::HarmonicSpectrum> spectra =
+        {
+            WavetableCreator::getSineSpectrum(),
+            WavetableCreator::getSawSpectrum(),
+            WavetableCreator::getRampSpectrum(),
+            WavetableCreator::getTriangleSpectrum(),
+            WavetableCreator::getSquareSpectrum()
+        };
+
+        // Map the tables saved by an earlier session, if they're still valid
+        File cacheFile = WavetableCache::getCacheFile("BaseWavetables", (unsigned int)tableSize);
+        std::vector<std::unique_ptr<MipmappedWavetable>> tables = WavetableCache::load(cacheFile, (unsigned int)tableSize, (int)spectra.size(),
+                                                                                       WavetableCreator::generatorVersion);
+
+        if (tables.empty())
+        {
+            // Render every level of every table at once, spread across the machine's cores alongside this thread
+            ThreadPool generatorPool(jmax(1, SystemStats::getNumCpus() - 1));
+            tables = WavetableCreator::createMipmappedTables((unsigned int)tableSize, spectra, &generatorPool);
+
+            // Not being able to write the cache only costs the next session a regeneration
+            WavetableCache::save(cacheFile, tables, WavetableCreator::generatorVersion);
+        }
+
+        return tables;
+    });
 }
 
 void SynthFrameworkAudioProcessor::initValueTrees()
@@ -284,6 +599,7 @@ void SynthFrameworkAudioProcessor::initValueTrees()
     EnvelopeParameters.setProperty(IDs::decay, 0.5f, nullptr);
     EnvelopeParameters.setProperty(IDs::sustain, 1.0f, nullptr);
     EnvelopeParameters.setProperty(IDs::release, 1.0f, nullptr);
+    EnvelopeParameters.setProperty(IDs::curve, "LINEAR", nullptr);
 
     // Copies must define: target
 
@@ -304,6 +620,8 @@ void SynthFrameworkAudioProcessor::initValueTrees()
     // Default parameters:
     OscillatorParameters.setProperty(IDs::enabled, 1, nullptr);
     OscillatorParameters.setProperty(IDs::waveType, "SINE", nullptr);
+    OscillatorParameters.setProperty(IDs::pan, 0.0f, nullptr);
+    OscillatorParameters.setProperty(IDs::framePosition, 0.0f, nullptr);
     OscillatorParameters.addChild(DetuneParameters.createCopy(), -1, nullptr);
 
     //==============================================================================
@@ -311,6 +629,13 @@ void SynthFrameworkAudioProcessor::initValueTrees()
     ValueTree oscillatorManagerParameters(IDs::OSC_MGR);
     oscillatorManagerParameters.setProperty(IDs::enabled, 1, nullptr);
     oscillatorManagerParameters.setProperty(IDs::voiceStealMode, "PORTAMENTO", nullptr);
+    oscillatorManagerParameters.setProperty(IDs::voiceStealPolicy, "OLDEST", nullptr);
+    oscillatorManagerParameters.setProperty(IDs::interpolation, "LINEAR", nullptr);
+    oscillatorManagerParameters.setProperty(IDs::pitchBendRange, 2, nullptr);
+    oscillatorManagerParameters.setProperty(IDs::silenceFloor, -96.0f, nullptr);
+    oscillatorManagerParameters.setProperty(IDs::silenceTime, 0.05f, nullptr);
+    oscillatorManagerParameters.setProperty(IDs::renderMode, "AUTO", nullptr);
+    oscillatorManagerParameters.setProperty(IDs::renderThreads, -1, nullptr);
 
     // Create a container node for the Oscillators
     ValueTree oscillators(IDs::OSC_GROUP);
@@ -12,6 +12,15 @@
 
 #include <JuceHeader.h>
 #include "Common.h"
+#include "ParameterSnapshot.h"
+#include "MipmappedWavetable.h"
+#include "WavetableSynthesiser.h"
+#include "OscillatorSet.h"
+#include "WavetableCollector.h"
+#include "WavetableRegistry.h"
+#include "WavetableLibrary.h"
+#include "PitchTable.h"
+#include "FadePool.h"
 
 //==============================================================================
 namespace
@@ -75,29 +84,141 @@ public:
 
         - Passes a wavetable reference as a CachedValue<> which can be accessed by the oscillator.
 
-        - Triggers a listener in WavetableOscillatorManager to create a new oscillator.
+        - Publishes a new OscillatorSet, which each voice picks up at the start of the next block.
     */
     void TREE_addOscillatorNode(var waveTypeToUse);
 
     /** Removes an oscillator node from the tree by its index.
 
-        - Triggers a listener in WavetableOscillatorManager to delete the oscillator.
+        - Publishes a new OscillatorSet without the oscillator, which each voice picks up at the start of the next block.
     */
     void TREE_removeOscillatorNode(int index);
 
     //==============================================================================
-    /** Returns a shared pointer to the wavetable buffer associated with a given waveType.
+    /** Returns a handle to the wavetable mip chain associated with a given waveType, or nullptr if there isn't one.
 
+        waveTypes not in the registry are looked up in the wavetable library. If the library has one that isn't resident yet,
+        it's prefetched and this returns nullptr; the oscillator set is published again once it has loaded.
     */
-    std::shared_ptr<AudioBuffer<float>> getWavetablePtrFromType(var waveType);
+    WavetableHandle getWavetablePtrFromType(var waveType);
+
+    /** Starts loading the library wavetables for a list of waveTypes, such as those of the next preset, so they're ready when needed.
+
+    */
+    void prefetchWavetables(const StringArray& waveTypes);
+
+    /** Imports a file of single-cycle frames in the background, as a waveType named after the file.
+
+        The file is added to the wavetable library, so like any other library table it's dropped when it's unused and over
+        the memory budget, and read again when it's next needed. Importing a file again picks up any changes to it.
+
+        Oscillators already set to that waveType pick it up once it's ready. onFinished is then called on the message thread
+        with an empty string, or with why the file couldn't be imported. Without onFinished, failures go to onWavetableError.
+        Message thread only.
+    */
+    void importWavetable(const File& file, std::function<void(const String& error)> onFinished = nullptr);
+
+    // Called on the message thread with a message for the user whenever a wavetable couldn't be loaded or imported
+    std::function<void(const String& message)> onWavetableError;
+
+    //==============================================================================
+    /** Returns the parameter snapshot picked up at the start of the current block.
+
+        Audio thread only. This is what voices read instead of the PARAMETERS tree.
+    */
+    const ParameterSnapshot& getParameterSnapshot() const noexcept;
+
+    /** Caps the interpolation the patch asks for, so playback can drop to a cheaper kernel when the CPU is under load.
+
+        Voices pick it up from the next block. Message thread only.
+    */
+    void setMaximumInterpolation(InterpolationMode newMaximum);
+
+    /** Returns the table voices tune their notes from, set to the sample rate by prepareToPlay.
+
+    */
+    const PitchTable& getPitchTable() const noexcept;
+
+    /** Returns the pool voices hand stolen notes to, to fade out while they start their new note. Audio thread only.
+
+    */
+    FadePool& getFadePool() noexcept;
+
+    /** Counts a voice retired early because its note fell silent. Safe from any thread, including render threads.
+
+    */
+    void countVoiceRetirement() noexcept;
+
+    /** Returns how many voices have been retired early since the plugin was created. Safe from any thread.
+
+    */
+    uint32 getNumVoiceRetirements() const noexcept;
+
+    //==============================================================================
+    void valueTreePropertyChanged(ValueTree& treeWhosePropertyHasChanged, const Identifier& property) override;
+    void valueTreeChildAdded(ValueTree& parentTree, ValueTree& childWhichHasBeenAdded) override;
+    void valueTreeChildRemoved(ValueTree& parentTree, ValueTree& childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved) override;
+    void valueTreeChildOrderChanged(ValueTree& parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex) override;
 
     //==============================================================================
 
 private:
+    // Frees wavetables once the audio thread can no longer be reading them. Shared by every instance in the process.
+    // Declared first so it outlives the sets, sounds and members holding handles to its tables
+    SharedResourcePointer<WavetableCollector> wavetableCollector;
+
+    // This processor's reader record in wavetableCollector. Every block is rendered inside it
+    WavetableCollector::Reader* wavetableReader = nullptr;
+
+    // Wavetables to be referenced by oscillators, shared with every other instance in the process
+    SharedResourcePointer<WavetableRegistry> wavetableRegistry;
+
+    // Wavetable files on disk, including imported ones, loaded on first use and kept within a memory budget
+    WavetableLibrary wavetableLibrary;
+
+    // Library tables queued by importWavetable, and who to tell once each has loaded or failed to. Message thread only
+    std::vector<std::pair<int, std::function<void(const String& error)>>> pendingImports;
+
     // The global parameter tree, which contains all settings
     ValueTree PARAMETERS;
 
-    Synthesiser mySynth;
+    // Compiled copies of PARAMETERS, published by the message thread and read by the audio thread
+    SnapshotExchange<ParameterSnapshot> parameterSnapshots;
+    uint32 parameterSnapshotVersion = 0;
+
+    // The most expensive kernel published, whatever the patch asks for
+    InterpolationMode maximumInterpolation = InterpolationMode::sinc;
+
+    // The oscillators every voice should hold, published by the message thread whenever they're added,
+    // removed, reordered or change wavetable
+    OscillatorSetExchange oscillatorSets;
+
+    // What was last published for each oscillator node. Message thread only
+    struct PublishedOscillator
+    {
+        ValueTree node;
+
+        // Kept while the node stays in the tree
+        uint32 id;
+
+        // The table its waveType resolved to, or nullptr if it's playing the sine until its library table loads
+        String waveType;
+        WavetableHandle wavetable;
+    };
+
+    std::vector<PublishedOscillator> publishedOscillators;
+    uint32 lastOscillatorId = 0;
+
+    // Every note's phase increment at the current sample rate. Declared before the synth, whose voices point at it
+    PitchTable pitchTable;
+
+    // Stolen notes fading out, shared by every voice. Declared before the synth, which renders it
+    FadePool fadePool { pitchTable };
+
+    // Voices retired early by silence detection. Incremented by whichever thread rendered the voice
+    std::atomic<uint32> numVoiceRetirements { 0 };
+
+    WavetableSynthesiser mySynth;
     int numVoices;
 
     double lastSampleRate;
@@ -105,27 +226,28 @@ private:
     // ==================
     // === WAVETABLES ===
     // ==================
-    // Wavetables to be referenced by oscillators
-    std::shared_ptr<AudioBuffer<float>> SineTable;
-    std::shared_ptr<AudioBuffer<float>> SawTable;
-    std::shared_ptr<AudioBuffer<float>> RampTable;
-    std::shared_ptr<AudioBuffer<float>> TriangleTable;
-    std::shared_ptr<AudioBuffer<float>> SquareTable;
-    
-    // TODO implement different wavetables for different frequencies
-    const int wavetableSize = 1024;
-
-
-    // Initializes the wavetables
-    void initBaseWavetables(int tableSize);
+    // Size of the largest level of each wavetable. Higher octaves use smaller tables
+    const int wavetableSize = 2048;
 
-    // Clears the memory of the base wavetables
-    // TODO store this externally instead
-    void clearWavetables();
+
+    // Makes sure the base wavetables are in the registry, mapping or generating them if this is the first instance
+    void initBaseWavetables(int tableSize);
 
     // Initializes the ValueTrees
     void initValueTrees();
 
+    // Rebuilds the parameter snapshot from PARAMETERS and hands it to the audio thread
+    void publishParameterSnapshot();
+
+    // Builds an OscillatorSet from the oscillator nodes in PARAMETERS and hands it to the audio thread
+    void publishOscillatorSet();
+
+    // Calls back every import waiting on a library table, with an empty error if it loaded. Returns false if none were
+    bool finishImports(int tableId, const String& error);
+
+    // Brings every voice in line with the latest OscillatorSet. Audio thread, or prepareToPlay
+    void applyOscillatorSet();
+
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SynthFrameworkAudioProcessor)
@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    SilenceDetector.h
+    Created: 18 Oct 2026 11:02:15am
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+
+/** Tells when a falling note has stayed below the silence floor for long enough to retire its voice.
+
+    Silence is counted in samples rather than blocks. A voice's blocks are split wherever a MIDI event lands,
+    so counting blocks would make how long a note must stay quiet depend on how busy the MIDI was.
+*/
+class SilenceDetector
+{
+public:
+    SilenceDetector() = default;
+
+    /** Sets how many samples in a row a note must be silent for before it's retired. 0 never retires a note.
+
+    */
+    void setHoldSamples(int numSamples) noexcept
+    {
+        holdSamples = jmax(0, numSamples);
+    }
+
+    int getHoldSamples() const noexcept
+    {
+        return holdSamples;
+    }
+
+    /** Counts a block of numSamples that either was silent throughout or wasn't, and returns true once the note
+        has been silent for at least the hold time.
+    */
+    bool addBlock(bool silent, int numSamples) noexcept
+    {
+        // Held at the hold time, so a long silence can't overflow the count
+        numSilentSamples = silent ? jmin(holdSamples, numSilentSamples + numSamples) : 0;
+
+        return holdSamples > 0 && numSilentSamples >= holdSamples;
+    }
+
+    /** Starts counting afresh, for a new note.
+
+    */
+    void reset() noexcept
+    {
+        numSilentSamples = 0;
+    }
+
+private:
+    int holdSamples = 0;
+
+    // Samples in a row the note has been silent for, up to the end of the last block counted, at most holdSamples
+    int numSilentSamples = 0;
+};
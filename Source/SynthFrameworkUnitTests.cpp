@@ -0,0 +1,17 @@
+/*
+  ==============================================================================
+
+    SynthFrameworkUnitTests.cpp
+    Created: 18 Oct 2026 9:12:40am
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+// Built into every configuration with JUCE_UNIT_TESTS set, which Debug is. The tests register themselves,
+// so UnitTestRunner().runTestsInCategory("SynthFramework") runs them from a debugger or a test host
+#if JUCE_UNIT_TESTS
+
+#include "SynthFrameworkUnitTests.h"
+
+#endif
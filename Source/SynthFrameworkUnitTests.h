@@ -11,4 +11,1138 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "PhaseAccumulator.h"
+#include "PitchTable.h"
+#include "WavetableCreator.h"
+#include "WavetableOscillator.h"
+#include "OscillatorBank.h"
+#include "WavetableSampleFormat.h"
+#include "WavetableCache.h"
+#include "BlockEnvelope.h"
+#include "FadePool.h"
+#include "VoiceAllocator.h"
+#include "SilenceDetector.h"
 
+
+//==================================================================================
+/** A pitch table at 48 kHz and a set of one saw oscillator, with id 1, for the suites that render through banks.
+
+*/
+struct SingleSawSetup
+{
+    SingleSawSetup()
+    {
+        pitchTable.setSampleRate(48000.0);
+
+        set.numOscillators = 1;
+        set.oscillators[0].id = 1;
+        set.oscillators[0].wavetable = WavetableCreator::createSawTable(2048);
+    }
+
+    PitchTable pitchTable;
+    OscillatorSet set;
+};
+
+
+//==================================================================================
+/** Compares the float and fixed-point phase engines for pitch drift and throughput.
+
+*/
+class PhaseAccumulatorTests : public UnitTest
+{
+public:
+    PhaseAccumulatorTests()
+        : UnitTest("Phase accumulators", "SynthFramework")
+    {
+    }
+
+    void runTest() override
+    {
+        const double sampleRate = 48000.0;
+        const int tableSize = 2048;
+
+        beginTest("Drift over a long note");
+        {
+            // Ten minutes of a slightly sharp A4
+            const double cyclesPerSample = 440.5 / sampleRate;
+            const int64 numSamples = (int64)(sampleRate * 600.0);
+
+            FloatPhase floatPhase;
+            FixedPointPhase fixedPhase;
+            initPhase(floatPhase, tableSize, cyclesPerSample);
+            initPhase(fixedPhase, tableSize, cyclesPerSample);
+
+            for (int64 i = 0; i < numSamples; ++i)
+            {
+                floatPhase.advance();
+                fixedPhase.advance();
+            }
+
+            double exactCycles = (double)numSamples * cyclesPerSample;
+            double expectedPosition = exactCycles - std::floor(exactCycles);
+
+            double floatError = getCycleDistance(floatPhase.getCyclePosition(), expectedPosition);
+            double fixedError = getCycleDistance(fixedPhase.getCyclePosition(), expectedPosition);
+
+            logMessage("Phase error after 10 minutes (cycles): float " + String(floatError) + ", fixed " + String(fixedError));
+
+            // The only error left in fixed point is the increment being rounded to 2^-32 of a cycle
+            expectLessThan(fixedError, (double)numSamples * std::ldexp(1.0, -33) + std::ldexp(1.0, -32));
+            expectLessThan(fixedError, floatError);
+        }
+
+        beginTest("Throughput");
+        {
+            std::shared_ptr<MipmappedWavetable> table = WavetableCreator::createSawTable(tableSize);
+            const float* samples = table->getLevelReadPointer(0);
+
+            const double cyclesPerSample = 440.0 / sampleRate;
+            const int blockSize = 512;
+            const int numBlocks = 20000;
+
+            HeapBlock<float> block((size_t)blockSize);
+
+            FloatPhase floatPhase;
+            FixedPointPhase fixedPhase;
+            initPhase(floatPhase, tableSize, cyclesPerSample);
+            initPhase(fixedPhase, tableSize, cyclesPerSample);
+
+            float checksum = 0.0f;
+            double floatSeconds = timeRender(floatPhase, samples, block, blockSize, numBlocks, checksum);
+            double fixedSeconds = timeRender(fixedPhase, samples, block, blockSize, numBlocks, checksum);
+
+            double numSamples = (double)blockSize * (double)numBlocks;
+            logMessage("Samples per second: float " + String(numSamples / floatSeconds, 0)
+                       + ", fixed " + String(numSamples / fixedSeconds, 0));
+
+            expect(std::isfinite(checksum));
+        }
+    }
+
+private:
+    template <typename PhaseType>
+    static void initPhase(PhaseType& phase, int tableSize, double cyclesPerSample)
+    {
+        phase.setTableSize(tableSize);
+        phase.setIncrement(cyclesPerSample);
+    }
+
+    // Distance between two positions in a cycle, accounting for wraparound
+    static double getCycleDistance(double a, double b)
+    {
+        double distance = std::abs(a - b);
+        return jmin(distance, 1.0 - distance);
+    }
+
+    // Renders numBlocks blocks with the same interpolation loop as WavetableOscillator, returning the time taken
+    template <typename PhaseType>
+    static double timeRender(PhaseType phase, const float* table, float* dest, int blockSize, int numBlocks, float& checksum)
+    {
+        int64 startTicks = Time::getHighResolutionTicks();
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            for (int i = 0; i < blockSize; ++i)
+            {
+                int index0 = phase.getIndex();
+                float frac = phase.getFraction();
+
+                dest[i] = table[index0] + frac * (table[index0 + 1] - table[index0]);
+
+                phase.advance();
+            }
+
+            // Stops the loop from being optimised away
+            checksum += dest[block % blockSize];
+        }
+
+        int64 endTicks = Time::getHighResolutionTicks();
+
+        return Time::highResolutionTicksToSeconds(endTicks - startTicks);
+    }
+};
+
+static PhaseAccumulatorTests phaseAccumulatorTests;
+
+
+//==================================================================================
+/** Checks the cents table against pow, and that pitch bend ramps land exactly on their target.
+
+*/
+class PitchTableTests : public UnitTest
+{
+public:
+    PitchTableTests()
+        : UnitTest("Pitch table", "SynthFramework")
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest("Cents ratios");
+        {
+            // Every pitch wheel position at the widest bend range, as WavetableOscillatorManager works them out
+            const double widestBendCents = 4800.0;
+            double worstError = 0.0;
+
+            for (int position = 0; position < 16384; ++position)
+            {
+                double cents = (double)(position - 8192) * (widestBendCents / 8192.0);
+                double exact = std::pow(2.0, cents / 1200.0);
+
+                worstError = jmax(worstError, std::abs(PitchTable::getCentsRatio(cents) / exact - 1.0));
+            }
+
+            logMessage("Worst relative error of the cents table: " + String(worstError));
+
+            // Linear interpolation between single cents is out by at most (ln 2 / 1200)^2 / 8, about 4e-8
+            expectLessThan(worstError, 1.0e-7);
+            expectEquals(PitchTable::getCentsRatio(-widestBendCents), 0.0625);
+            expectEquals(PitchTable::getCentsRatio(widestBendCents), 16.0);
+        }
+
+        beginTest("Pitch ramps");
+        {
+            SingleSawSetup setup;
+
+            HeapBlock<float> block((size_t)512);
+
+            for (int numSamples : { 1, 7, 64, 512 })
+            {
+                for (double cents : { 200.0, -1250.0 })
+                {
+                    String description = String(cents) + " cents over " + String(numSamples) + " samples";
+                    double ratio = PitchTable::getCentsRatio(cents);
+
+                    // On its own, and through a bank, which renders in lanes when it can
+                    WavetableOscillator osc(setup.set.oscillators[0].wavetable.get());
+                    osc.setPitchTable(setup.pitchTable);
+                    osc.setNote(60);
+
+                    osc.rampPitchRatio(ratio, numSamples);
+                    expect(osc.getPhase().incrementStep != 0, description);
+
+                    FloatVectorOperations::clear(block, numSamples);
+                    osc.renderBlock(block, numSamples, 1.0f);
+                    expectRampFinished(osc, setup.pitchTable.getNoteIncrement(60) * ratio, description);
+
+                    auto bank = std::make_unique<OscillatorBank>();
+                    bank->applyOscillatorSet(setup.set, setup.pitchTable, 60);
+
+                    bank->rampPitchRatio(ratio, numSamples);
+                    FloatVectorOperations::clear(block, numSamples);
+                    bank->renderBlock(block, numSamples, 1.0f);
+                    expectRampFinished(bank->getOscillator(0), setup.pitchTable.getNoteIncrement(60) * ratio, description + " in a bank");
+                }
+            }
+        }
+    }
+
+private:
+    // Checks the oscillator holds exactly the increment that cyclesPerSample sets, with nothing left to ramp
+    void expectRampFinished(const WavetableOscillator& osc, double cyclesPerSample, const String& description)
+    {
+        OscillatorPhase target = osc.getPhase();
+        target.setIncrement(cyclesPerSample);
+
+        expect(osc.getPhase().increment == target.increment, description + ": increment");
+        expect(osc.getPhase().incrementStep == 0, description + ": increment step");
+    }
+};
+
+static PitchTableTests pitchTableTests;
+
+
+//==================================================================================
+/** Compares compact int16 and float16 wavetables against float32 ones for quality, size and throughput.
+
+*/
+class CompactWavetableTests : public UnitTest
+{
+public:
+    CompactWavetableTests()
+        : UnitTest("Compact wavetables", "SynthFramework")
+    {
+    }
+
+    void runTest() override
+    {
+        const int tableSize = 2048;
+
+        PitchTable pitchTable;
+        pitchTable.setSampleRate(48000.0);
+
+        // A multi-frame saw to square bank, so the morphing kernel is measured too
+        std::vector<WavetableCreator::HarmonicSpectrum> frames { WavetableCreator::getSawSpectrum(),
+                                                                 WavetableCreator::getTriangleSpectrum(),
+                                                                 WavetableCreator::getSquareSpectrum() };
+
+        std::unique_ptr<MipmappedWavetable> floatTable = WavetableCreator::createMultiFrameTable(tableSize, frames, nullptr);
+        std::unique_ptr<MipmappedWavetable> int16Table = WavetableCreator::createCompactTable(*floatTable, WavetableSampleFormat::int16);
+        std::unique_ptr<MipmappedWavetable> float16Table = WavetableCreator::createCompactTable(*floatTable, WavetableSampleFormat::float16);
+
+        beginTest("Size");
+        {
+            double floatBytes = (double)floatTable->getSizeInBytes();
+
+            logMessage("Bytes: float32 " + String((int64)floatTable->getSizeInBytes())
+                       + ", int16 " + String((int64)int16Table->getSizeInBytes())
+                       + ", float16 " + String((int64)float16Table->getSizeInBytes()));
+
+            expectLessOrEqual((double)int16Table->getSizeInBytes(), floatBytes * 0.55);
+            expectLessOrEqual((double)float16Table->getSizeInBytes(), floatBytes * 0.55);
+        }
+
+        beginTest("Quality");
+        {
+            // Signal to error ratio of each format against float32, over notes spanning every level and positions between frames
+            double int16Ratio = getWorstSignalToError(*floatTable, *int16Table, pitchTable);
+            double float16Ratio = getWorstSignalToError(*floatTable, *float16Table, pitchTable);
+
+            logMessage("Worst signal to error (dB): int16 " + String(int16Ratio, 1) + ", float16 " + String(float16Ratio, 1));
+
+            // About 16 bits of an int16 frame, and the 11 bit mantissa of a half, less headroom for interpolation
+            expectGreaterThan(int16Ratio, 80.0);
+            expectGreaterThan(float16Ratio, 60.0);
+        }
+
+        beginTest("Throughput");
+        {
+            double floatRate = getSamplesPerSecond(*floatTable, pitchTable);
+            double int16Rate = getSamplesPerSecond(*int16Table, pitchTable);
+            double float16Rate = getSamplesPerSecond(*float16Table, pitchTable);
+
+            logMessage("Morphing samples per second: float32 " + String(floatRate, 0)
+                       + ", int16 " + String(int16Rate, 0) + ", float16 " + String(float16Rate, 0));
+
+            expect(floatRate > 0.0 && int16Rate > 0.0 && float16Rate > 0.0);
+        }
+    }
+
+private:
+    static constexpr int blockSize = 512;
+
+    static void initOscillator(WavetableOscillator& osc, const MipmappedWavetable& table, const PitchTable& pitchTable, int note, float position)
+    {
+        osc.setWavetable(&table);
+        osc.setPitchTable(pitchTable);
+        osc.setNote(note);
+        osc.setFramePosition(position);
+
+        // Glide all the way to the position
+        for (int i = 0; i < 100; ++i)
+        {
+            osc.advanceFramePosition(blockSize);
+        }
+    }
+
+    // The lowest signal to error ratio, in dB, of test against reference across a spread of notes and frame positions
+    double getWorstSignalToError(const MipmappedWavetable& reference, const MipmappedWavetable& test, const PitchTable& pitchTable)
+    {
+        double worst = std::numeric_limits<double>::max();
+
+        HeapBlock<float> referenceBlock((size_t)blockSize);
+        HeapBlock<float> testBlock((size_t)blockSize);
+
+        for (int note = 24; note <= 108; note += 12)
+        {
+            for (float position : { 0.0f, 0.3f, 0.75f, 1.0f })
+            {
+                WavetableOscillator referenceOsc;
+                WavetableOscillator testOsc;
+                initOscillator(referenceOsc, reference, pitchTable, note, position);
+                initOscillator(testOsc, test, pitchTable, note, position);
+
+                FloatVectorOperations::clear(referenceBlock, blockSize);
+                FloatVectorOperations::clear(testBlock, blockSize);
+                referenceOsc.renderBlock(referenceBlock, blockSize, 1.0f);
+                testOsc.renderBlock(testBlock, blockSize, 1.0f);
+
+                double signal = 0.0;
+                double error = 0.0;
+
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    double difference = (double)testBlock[i] - (double)referenceBlock[i];
+                    signal += (double)referenceBlock[i] * (double)referenceBlock[i];
+                    error += difference * difference;
+                }
+
+                double ratio = error > 0.0 ? 10.0 * std::log10(signal / error) : 200.0;
+                worst = jmin(worst, ratio);
+            }
+        }
+
+        return worst;
+    }
+
+    // Renders 64 morphing oscillators for a while, as a voice-heavy patch would, and returns the rate they were rendered at
+    double getSamplesPerSecond(const MipmappedWavetable& table, const PitchTable& pitchTable)
+    {
+        const int numOscillators = 64;
+        const int numBlocks = 500;
+
+        std::vector<WavetableOscillator> oscillators((size_t)numOscillators);
+
+        for (int i = 0; i < numOscillators; ++i)
+        {
+            initOscillator(oscillators[(size_t)i], table, pitchTable, 36 + i % 48, 0.1f + 0.8f * (float)i / (float)numOscillators);
+        }
+
+        HeapBlock<float> block((size_t)blockSize);
+        float checksum = 0.0f;
+
+        int64 startTicks = Time::getHighResolutionTicks();
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            FloatVectorOperations::clear(block, blockSize);
+
+            for (WavetableOscillator& osc : oscillators)
+            {
+                osc.renderBlock(block, blockSize, 0.01f);
+            }
+
+            // Stops the loop from being optimised away
+            checksum += block[b % blockSize];
+        }
+
+        double seconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks);
+
+        expect(std::isfinite(checksum));
+
+        return (double)numOscillators * (double)blockSize * (double)numBlocks / seconds;
+    }
+};
+
+static CompactWavetableTests compactWavetableTests;
+
+
+//==================================================================================
+/** Saves a set of tables to a cache file and maps it back, then checks a corrupt sample makes the file be rejected.
+
+*/
+class WavetableCacheTests : public UnitTest
+{
+public:
+    WavetableCacheTests()
+        : UnitTest("Wavetable cache", "SynthFramework")
+    {
+    }
+
+    void runTest() override
+    {
+        const unsigned int tableSize = 256;
+        const uint32 contentVersion = 1;
+
+        std::vector<std::unique_ptr<MipmappedWavetable>> tables;
+        tables.push_back(WavetableCreator::createSawTable(tableSize));
+        tables.push_back(WavetableCreator::createSquareTable(tableSize));
+
+        TemporaryFile temporaryFile(".sfwt");
+        const File& file = temporaryFile.getFile();
+
+        beginTest("Round trip");
+        {
+            expect(WavetableCache::save(file, tables, contentVersion));
+
+            auto loaded = WavetableCache::load(file, tableSize, (int)tables.size(), contentVersion);
+            expectEquals((int)loaded.size(), (int)tables.size());
+
+            for (size_t i = 0; i < loaded.size(); ++i)
+            {
+                expect(matches(*loaded[i], *tables[i]));
+            }
+        }
+
+        beginTest("Corrupt samples");
+        {
+            MemoryBlock contents;
+            expect(file.loadFileAsData(contents));
+
+            // A bit near the end of the last table's smallest level, well past the header and directory
+            static_cast<uint8*>(contents.getData())[contents.getSize() - sizeof(float) * 2] ^= 0x10;
+            expect(file.replaceWithData(contents.getData(), contents.getSize()));
+
+            expect(WavetableCache::load(file, tableSize, (int)tables.size(), contentVersion).empty());
+        }
+    }
+
+private:
+    // True if two chains have the same levels holding the same samples, guard samples included
+    static bool matches(const MipmappedWavetable& a, const MipmappedWavetable& b)
+    {
+        if (a.getNumLevels() != b.getNumLevels() || a.getNumFrames() != b.getNumFrames())
+        {
+            return false;
+        }
+
+        for (int level = 0; level < a.getNumLevels(); ++level)
+        {
+            size_t numBytes = sizeof(float) * (size_t)a.getFrameStride(level) * (size_t)a.getNumFrames();
+
+            if (a.getLevelSize(level) != b.getLevelSize(level)
+                || a.getFrameStride(level) != b.getFrameStride(level)
+                || std::memcmp(a.getLevelStorage(level), b.getLevelStorage(level), numBytes) != 0)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+static WavetableCacheTests wavetableCacheTests;
+
+
+//==================================================================================
+/** Compares BlockEnvelope against juce::ADSR, and checks its exponential stages and mid-stage parameter changes.
+
+*/
+class BlockEnvelopeTests : public UnitTest
+{
+public:
+    BlockEnvelopeTests()
+        : UnitTest("Block envelope", "SynthFramework")
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest("Matches juce::ADSR");
+        {
+            // Note on, note off, a retrigger partway through the release, and a second release
+            const std::vector<Event> events { { 0, Event::noteOn }, { 6000, Event::noteOff },
+                                              { 6500, Event::noteOn }, { 14000, Event::noteOff } };
+
+            for (int blockSize : blockSizes)
+            {
+                float difference = getLargestDifference(getLinearParameters(), events, 18000, blockSize);
+                expectLessThan(difference, 2.0e-4f, "Block size " + String(blockSize));
+            }
+        }
+
+        beginTest("Exponential stage timing");
+        {
+            BlockEnvelope::Parameters parameters = getLinearParameters();
+            parameters.attack = 0.0f;
+            parameters.curve = BlockEnvelope::Curve::exponential;
+
+            const int numDecaySamples = (int)(parameters.decay * sampleRate);
+            const int numReleaseSamples = (int)(parameters.release * sampleRate);
+            const int releaseStart = numDecaySamples + 1000;
+
+            const std::vector<Event> events { { 0, Event::noteOn }, { releaseStart, Event::noteOff } };
+
+            for (int blockSize : blockSizes)
+            {
+                // Each stage lands exactly on its end on its last sample, having stayed short of it until then. A decay to
+                // silence is timed, as near a higher sustain the last few samples round to it
+                BlockEnvelope::Parameters silentParameters = parameters;
+                silentParameters.sustain = 0.0f;
+
+                std::vector<float> silentOutput = renderEnvelope(silentParameters, { { 0, Event::noteOn } }, numDecaySamples + 100, blockSize);
+                expectEquals(getFirstIndexAtOrBelow(silentOutput, 0, 0.0f), numDecaySamples - 1);
+
+                std::vector<float> output = renderEnvelope(parameters, events, releaseStart + numReleaseSamples + 100, blockSize);
+                expectEquals(output[(size_t)numDecaySamples - 1], parameters.sustain);
+                expectEquals(getFirstIndexAtOrBelow(output, releaseStart, 0.0f), releaseStart + numReleaseSamples - 1);
+
+                // Halfway through the decay, the curve has covered all but the overshoot's square root of the distance
+                float range = 1.0f - parameters.sustain;
+                float halfway = parameters.sustain + range * std::sqrt(exponentialOvershoot) * (1.0f + exponentialOvershoot)
+                                - range * exponentialOvershoot;
+                expectWithinAbsoluteError(output[(size_t)(numDecaySamples / 2 - 1)], halfway, 1.0e-3f);
+            }
+        }
+
+        beginTest("Sustain changed mid-decay");
+        {
+            const int midDecay = (int)((getLinearParameters().attack + getLinearParameters().decay * 0.5f) * sampleRate);
+            const int numSamples = midDecay + (int)(getLinearParameters().decay * sampleRate) + 100;
+
+            for (float newSustain : { 0.2f, 0.9f })
+            {
+                const std::vector<Event> events { { 0, Event::noteOn }, { midDecay, Event::setSustain, newSustain } };
+
+                for (int blockSize : blockSizes)
+                {
+                    String description = "Sustain " + String(newSustain) + ", block size " + String(blockSize);
+
+                    float difference = getLargestDifference(getLinearParameters(), events, numSamples, blockSize);
+                    expectLessThan(difference, 2.0e-4f, description);
+
+                    BlockEnvelope::Parameters parameters = getLinearParameters();
+                    parameters.curve = BlockEnvelope::Curve::exponential;
+
+                    std::vector<float> output = renderEnvelope(parameters, events, numSamples, blockSize);
+
+                    bool inRange = std::all_of(output.begin(), output.end(), [] (float sample) { return sample >= 0.0f && sample <= 1.0f; });
+                    expect(inRange, description);
+
+                    // A raised sustain is stepped up to at once, and a lowered one is reached within the decay time
+                    expectEquals(output.back(), newSustain, description);
+
+                    if (newSustain > output[(size_t)midDecay - 1])
+                    {
+                        expectEquals(output[(size_t)midDecay], newSustain, description);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr float exponentialOvershoot = 1.0e-4f;
+
+    // Sizes chosen so stages end inside blocks, on their boundaries and across several
+    const std::vector<int> blockSizes { 1, 7, 64, 480, 512 };
+
+    struct Event
+    {
+        enum Type
+        {
+            noteOn,
+            noteOff,
+            setSustain
+        };
+
+        int time;
+        Type type;
+        float sustain = 0.0f;
+    };
+
+    static BlockEnvelope::Parameters getLinearParameters()
+    {
+        BlockEnvelope::Parameters parameters;
+        parameters.attack = 0.01f;
+        parameters.decay = 0.1f;
+        parameters.sustain = 0.5f;
+        parameters.release = 0.05f;
+
+        return parameters;
+    }
+
+    template <typename EnvelopeType, typename ParametersType>
+    static void applyEvent(EnvelopeType& envelope, ParametersType& parameters, const Event& event)
+    {
+        switch (event.type)
+        {
+            case Event::noteOn:     envelope.noteOn(); break;
+            case Event::noteOff:    envelope.noteOff(); break;
+            case Event::setSustain:
+            default:                parameters.sustain = event.sustain; envelope.setParameters(parameters); break;
+        }
+    }
+
+    // Renders numSamples of a BlockEnvelope in blocks of blockSize, split wherever an event falls inside one, as the synth does
+    static std::vector<float> renderEnvelope(BlockEnvelope::Parameters parameters, const std::vector<Event>& events, int numSamples, int blockSize)
+    {
+        BlockEnvelope envelope;
+        envelope.setSampleRate(sampleRate);
+        envelope.setParameters(parameters);
+
+        std::vector<float> output((size_t)numSamples);
+        size_t nextEvent = 0;
+        int position = 0;
+
+        while (position < numSamples)
+        {
+            while (nextEvent < events.size() && events[nextEvent].time <= position)
+            {
+                applyEvent(envelope, parameters, events[nextEvent++]);
+            }
+
+            int end = jmin(numSamples, position + blockSize);
+
+            if (nextEvent < events.size())
+            {
+                end = jmin(end, events[nextEvent].time);
+            }
+
+            envelope.renderBlock(output.data() + position, end - position, 1.0f);
+            position = end;
+        }
+
+        return output;
+    }
+
+    // Renders numSamples of a juce::ADSR with the same linear parameters, a sample at a time
+    static std::vector<float> renderReference(const BlockEnvelope::Parameters& blockParameters, const std::vector<Event>& events, int numSamples)
+    {
+        ADSR::Parameters parameters;
+        parameters.attack = blockParameters.attack;
+        parameters.decay = blockParameters.decay;
+        parameters.sustain = blockParameters.sustain;
+        parameters.release = blockParameters.release;
+
+        ADSR envelope;
+        envelope.setSampleRate(sampleRate);
+        envelope.setParameters(parameters);
+
+        std::vector<float> output((size_t)numSamples);
+        size_t nextEvent = 0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            while (nextEvent < events.size() && events[nextEvent].time <= i)
+            {
+                applyEvent(envelope, parameters, events[nextEvent++]);
+            }
+
+            output[(size_t)i] = envelope.getNextSample();
+        }
+
+        return output;
+    }
+
+    static float getLargestDifference(const BlockEnvelope::Parameters& parameters, const std::vector<Event>& events, int numSamples, int blockSize)
+    {
+        std::vector<float> output = renderEnvelope(parameters, events, numSamples, blockSize);
+        std::vector<float> reference = renderReference(parameters, events, numSamples);
+
+        float largest = 0.0f;
+
+        for (size_t i = 0; i < output.size(); ++i)
+        {
+            largest = jmax(largest, std::abs(output[i] - reference[i]));
+        }
+
+        return largest;
+    }
+
+    // The first index from start whose sample is at or below level, or -1
+    static int getFirstIndexAtOrBelow(const std::vector<float>& output, int start, float level)
+    {
+        for (size_t i = (size_t)start; i < output.size(); ++i)
+        {
+            if (output[i] <= level)
+            {
+                return (int)i;
+            }
+        }
+
+        return -1;
+    }
+};
+
+static BlockEnvelopeTests blockEnvelopeTests;
+
+
+//==================================================================================
+/** Checks that a fade taken over part way through a pitch bend holds its pitch.
+
+*/
+class FadePoolTests : public UnitTest
+{
+public:
+    FadePoolTests()
+        : UnitTest("Fade pool", "SynthFramework")
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest("A fade started during a bend holds its pitch");
+        {
+            SingleSawSetup setup;
+
+            auto bank = std::make_unique<OscillatorBank>();
+            bank->applyOscillatorSet(setup.set, setup.pitchTable, 60);
+
+            HeapBlock<float> block((size_t)blockSize);
+
+            // A block of a bend up two semitones, after which a steal hands the note to the pool
+            bank->rampPitchRatio(PitchTable::getCentsRatio(200.0), blockSize);
+            FloatVectorOperations::clear(block, blockSize);
+            bank->renderBlock(block, blockSize, 1.0f);
+
+            BlockEnvelope envelope;
+            envelope.setSampleRate(48000.0);
+            envelope.noteOn();
+            envelope.renderBlock(block, blockSize, 1.0f);
+
+            FadePool pool(setup.pitchTable, 1);
+            pool.prepareToPlay(blockSize);
+            pool.startFade(*bank, envelope, 1.0f, 0.05f);
+
+            const WavetableOscillator& fadingOscillator = pool.getSlotOscillators(0).getOscillator(0);
+            const int level = fadingOscillator.getCurrentLevel();
+
+            // With a constant increment, every block moves the phase on by the same amount
+            double position = fadingOscillator.getCyclePosition();
+            double firstAdvance = -1.0;
+
+            for (int b = 0; b < 8; ++b)
+            {
+                FloatVectorOperations::clear(block, blockSize);
+                pool.renderBlock(block, nullptr, blockSize);
+
+                double advance = fadingOscillator.getCyclePosition() - position;
+                advance -= std::floor(advance);
+                position = fadingOscillator.getCyclePosition();
+
+                if (firstAdvance < 0.0)
+                {
+                    firstAdvance = advance;
+                }
+
+                double difference = std::abs(advance - firstAdvance);
+                expectLessThan(jmin(difference, 1.0 - difference), 1.0e-4, "Block " + String(b));
+                expectEquals(fadingOscillator.getCurrentLevel(), level);
+            }
+
+            expectEquals(pool.getNumActiveFades(), 1);
+        }
+    }
+
+private:
+    static constexpr int blockSize = 256;
+};
+
+static FadePoolTests fadePoolTests;
+
+
+//==================================================================================
+/** Checks each steal policy, and compares the allocator against scanning every voice, as Synthesiser does, under dense MIDI.
+
+*/
+class VoiceAllocatorTests : public UnitTest
+{
+public:
+    VoiceAllocatorTests()
+        : UnitTest("Voice allocator", "SynthFramework")
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest("Stealing policies");
+        {
+            VoiceAllocator allocator;
+            allocator.prepare(4);
+
+            // A chord over a low bass note, started in voice order
+            for (int note : { 36, 60, 64, 67 })
+            {
+                allocator.voiceStarted(allocator.findFreeVoice(), note);
+            }
+
+            expectEquals(allocator.findFreeVoice(), -1);
+            expectEquals(allocator.getLowestHeldNote(), 36);
+
+            allocator.setStealPolicy(VoiceStealPolicy::oldest);
+            expectEquals(allocator.findVoiceToSteal(), 0);
+
+            allocator.setStealPolicy(VoiceStealPolicy::lowestNoteProtected);
+            expectEquals(allocator.findVoiceToSteal(), 1);
+
+            // Released voices go first, whatever their age
+            allocator.voiceReleased(2);
+            expectEquals(allocator.findVoiceToSteal(), 2);
+
+            allocator.setStealPolicy(VoiceStealPolicy::oldest);
+            expectEquals(allocator.findVoiceToSteal(), 2);
+
+            allocator.setStealPolicy(VoiceStealPolicy::quietest);
+            const float levels[] = { 0.5f, 0.2f, 0.9f, 0.1f };
+            allocator.updateActiveVoices([&levels] (int index) { return levels[index]; });
+            expectEquals(allocator.findVoiceToSteal(), 3);
+
+            // A stolen voice leaves the heap until its new level is known
+            allocator.voiceStarted(3, 70);
+            expectEquals(allocator.findVoiceToSteal(), 1);
+
+            // A voice whose note has ended is freed
+            allocator.updateActiveVoices([] (int index) { return index == 2 ? -1.0f : 0.5f; });
+            expectEquals(allocator.findFreeVoice(), 2);
+            expectEquals(allocator.getNumActiveVoices(), 3);
+        }
+
+        beginTest("Dense MIDI");
+        {
+            for (int numVoices : { 256, 1024 })
+            {
+                int mismatches = 0;
+                playDenseMidi(numVoices, true, &mismatches);
+                expectEquals(mismatches, 0, "The allocator's oldest voice should match a scan for it");
+
+                double allocatorSeconds = playDenseMidi(numVoices, true, nullptr);
+                double scanSeconds = playDenseMidi(numVoices, false, nullptr);
+
+                // Timings depend on the machine and the build, so they're only reported, never checked
+                logMessage(String(numVoices) + " voices, events per second: allocator " + String(numEvents / allocatorSeconds, 0)
+                           + ", scan " + String(numEvents / scanSeconds, 0)
+                           + " (" + String(scanSeconds / allocatorSeconds, 1) + "x)");
+            }
+        }
+    }
+
+private:
+    static constexpr int numEvents = 200000;
+
+    // Events between blocks, each of which updates every active voice's level
+    static constexpr int eventsPerBlock = 32;
+
+    enum VoiceState
+    {
+        freeState,
+        heldState,
+        releasedState
+    };
+
+    /** Plays the same stream of random notes into numVoices voices, and returns the seconds taken.
+
+        Voices are chosen by a VoiceAllocator stealing the oldest, or by scanning every voice for a free one or the oldest.
+        Released voices fade over a dozen blocks. If mismatches isn't null, each voice the allocator steals is checked
+        against a scan, and the number that differ is counted.
+    */
+    double playDenseMidi(int numVoices, bool useAllocator, int* mismatches)
+    {
+        VoiceAllocator allocator;
+        allocator.prepare(numVoices);
+        allocator.setStealPolicy(VoiceStealPolicy::oldest);
+
+        std::vector<int> states((size_t)numVoices, freeState);
+        std::vector<float> levels((size_t)numVoices, 0.0f);
+
+        // When each voice joined its state, so a scan can find the oldest
+        std::vector<int64> stamps((size_t)numVoices, 0);
+        int64 time = 0;
+
+        Random random(0x5eed);
+
+        int64 startTicks = Time::getHighResolutionTicks();
+
+        for (int event = 0; event < numEvents; ++event)
+        {
+            int note = 24 + random.nextInt(72);
+
+            if (random.nextInt(10) < 6)
+            {
+                int index = useAllocator ? allocator.findFreeVoice() : scanForFreeVoice(states);
+
+                if (index < 0)
+                {
+                    index = useAllocator ? allocator.findVoiceToSteal() : scanForOldestVoice(states, stamps);
+
+                    if (mismatches != nullptr && index != scanForOldestVoice(states, stamps))
+                    {
+                        ++*mismatches;
+                    }
+                }
+
+                states[(size_t)index] = heldState;
+                levels[(size_t)index] = (float)note / 127.0f;
+                stamps[(size_t)index] = ++time;
+
+                if (useAllocator)
+                {
+                    allocator.voiceStarted(index, note);
+                }
+            }
+            else
+            {
+                int index = random.nextInt(numVoices);
+
+                if (states[(size_t)index] == heldState)
+                {
+                    states[(size_t)index] = releasedState;
+                    stamps[(size_t)index] = ++time;
+
+                    if (useAllocator)
+                    {
+                        allocator.voiceReleased(index);
+                    }
+                }
+            }
+
+            if (event % eventsPerBlock == eventsPerBlock - 1)
+            {
+                if (useAllocator)
+                {
+                    allocator.updateActiveVoices([&] (int index) { return updateVoice(states, levels, index); });
+                }
+                else
+                {
+                    for (int index = 0; index < numVoices; ++index)
+                    {
+                        updateVoice(states, levels, index);
+                    }
+                }
+            }
+        }
+
+        return Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks);
+    }
+
+    // Fades a released voice, freeing it once it's quiet, and returns its level, or -1 if it's free
+    static float updateVoice(std::vector<int>& states, std::vector<float>& levels, int index)
+    {
+        if (states[(size_t)index] == releasedState)
+        {
+            levels[(size_t)index] *= 0.7f;
+
+            if (levels[(size_t)index] < 0.01f)
+            {
+                states[(size_t)index] = freeState;
+            }
+        }
+
+        return states[(size_t)index] == freeState ? -1.0f : levels[(size_t)index];
+    }
+
+    static int scanForFreeVoice(const std::vector<int>& states)
+    {
+        for (size_t i = 0; i < states.size(); ++i)
+        {
+            if (states[i] == freeState)
+            {
+                return (int)i;
+            }
+        }
+
+        return -1;
+    }
+
+    // The oldest released voice, or failing that the oldest held one
+    static int scanForOldestVoice(const std::vector<int>& states, const std::vector<int64>& stamps)
+    {
+        int oldestReleased = -1;
+        int oldestHeld = -1;
+
+        for (size_t i = 0; i < states.size(); ++i)
+        {
+            int& oldest = states[i] == releasedState ? oldestReleased : oldestHeld;
+
+            if (states[i] != freeState && (oldest < 0 || stamps[i] < stamps[(size_t)oldest]))
+            {
+                oldest = (int)i;
+            }
+        }
+
+        return oldestReleased >= 0 ? oldestReleased : oldestHeld;
+    }
+};
+
+static VoiceAllocatorTests voiceAllocatorTests;
+
+
+//==================================================================================
+/** Checks that a falling note is retired after the same length of silence however its blocks are split.
+
+*/
+class SilenceDetectorTests : public UnitTest
+{
+public:
+    SilenceDetectorTests()
+        : UnitTest("Silence detection", "SynthFramework")
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest("Retirement doesn't depend on the block split");
+        {
+            // The first sample of a decay to silence that's below the floor, rendered in one go
+            HeapBlock<float> block((size_t)maxBlockSize);
+
+            BlockEnvelope reference = startDecayingNote();
+            reference.renderBlock(block, maxBlockSize, 1.0f);
+
+            int firstQuietSample = 0;
+
+            while (firstQuietSample < maxBlockSize && block[firstQuietSample] >= silenceFloor)
+            {
+                ++firstQuietSample;
+            }
+
+            expectLessThan(firstQuietSample, maxBlockSize);
+
+            // Fixed sub-blocks from single samples to whole blocks, and random ones like a busy MIDI stream would make.
+            // Counting starts with the first block to begin below the floor, and a note is retired at the end of the
+            // block that completes the hold, so each can land up to a block later
+            for (int subBlockSize : { 0, 1, 16, 128, 512 })
+            {
+                Random random(subBlockSize);
+
+                BlockEnvelope envelope = startDecayingNote();
+
+                SilenceDetector detector;
+                detector.setHoldSamples(holdSamples);
+
+                int position = 0;
+                int retiredAt = -1;
+                int largestBlock = 0;
+
+                while (retiredAt < 0 && position < maxBlockSize)
+                {
+                    int numSamples = subBlockSize > 0 ? subBlockSize : 1 + random.nextInt(200);
+                    largestBlock = jmax(largestBlock, numSamples);
+
+                    // As WavetableOscillatorManager decides it, from the first sample of a block outside the attack
+                    bool falling = !envelope.isInAttack();
+                    envelope.renderBlock(block, numSamples, 1.0f);
+                    bool silent = falling && block[0] < silenceFloor;
+
+                    position += numSamples;
+
+                    if (detector.addBlock(silent, numSamples))
+                    {
+                        retiredAt = position;
+                    }
+                }
+
+                String description = subBlockSize > 0 ? "Sub-blocks of " + String(subBlockSize) : String("Random sub-blocks");
+
+                expectGreaterOrEqual(retiredAt, firstQuietSample + holdSamples, description);
+                expectLessThan(retiredAt, firstQuietSample + holdSamples + 2 * largestBlock, description);
+            }
+        }
+
+        beginTest("Sound restarts the count");
+        {
+            SilenceDetector detector;
+            detector.setHoldSamples(holdSamples);
+
+            expect(!detector.addBlock(true, holdSamples - 1));
+            expect(!detector.addBlock(false, 1));
+            expect(!detector.addBlock(true, holdSamples - 1));
+            expect(detector.addBlock(true, 1));
+
+            // No hold time never retires, however long the silence, which would overflow an unclamped count
+            detector.setHoldSamples(0);
+
+            for (int i = 0; i < 4; ++i)
+            {
+                expect(!detector.addBlock(true, std::numeric_limits<int>::max() / 2));
+            }
+        }
+    }
+
+private:
+    static constexpr int holdSamples = 2400;
+    static constexpr int maxBlockSize = 20000;
+
+    const float silenceFloor = Decibels::decibelsToGain(-40.0f);
+
+    // A note with no attack, decaying linearly to a silent sustain over 2400 samples
+    static BlockEnvelope startDecayingNote()
+    {
+        BlockEnvelope::Parameters parameters;
+        parameters.attack = 0.0f;
+        parameters.decay = 0.05f;
+        parameters.sustain = 0.0f;
+
+        BlockEnvelope envelope;
+        envelope.setSampleRate(48000.0);
+        envelope.setParameters(parameters);
+        envelope.noteOn();
+
+        return envelope;
+    }
+};
+
+static SilenceDetectorTests silenceDetectorTests;
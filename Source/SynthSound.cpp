@@ -13,7 +13,7 @@
 
 //==============================================================================
 
-SynthSound::SynthSound(std::shared_ptr<AudioBuffer<float>> table)
+SynthSound::SynthSound(WavetableHandle table)
     : wavetable (table)
 {
 
@@ -29,7 +29,7 @@ bool SynthSound::appliesToChannel(int midiChannel)
     return true;
 }
 
-std::shared_ptr<AudioBuffer<float>> SynthSound::getWavetable()
+WavetableHandle SynthSound::getWavetable()
 {
     return wavetable;
 }
\ No newline at end of file
@@ -11,12 +11,13 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "WavetableCollector.h"
 
 // Container object for a wavetable to be played by a voice
 class SynthSound : public SynthesiserSound
 {
 public:
-    SynthSound(std::shared_ptr<AudioBuffer<float>> table);
+    SynthSound(WavetableHandle table);
 
     //==============================================================================
 
@@ -26,8 +27,8 @@ public:
 
     //==============================================================================
 
-    std::shared_ptr<AudioBuffer<float>> getWavetable();
+    WavetableHandle getWavetable();
 
 private:
-    std::shared_ptr<AudioBuffer<float>> wavetable;
+    WavetableHandle wavetable;
 };
\ No newline at end of file
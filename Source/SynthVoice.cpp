@@ -17,12 +17,12 @@
 // === JUCE OVERRIDES ===
 // ======================
 
-// Constructor takes in the tree containing the parameters for its oscillator manager
-SynthVoice::SynthVoice(ValueTree oscMgrParams, SynthFrameworkAudioProcessor& p)
+// Oscillators and their parameters reach the oscillator manager through the processor, rather than the tree
+SynthVoice::SynthVoice(SynthFrameworkAudioProcessor& p)
     : processor(p)
 {
     // Init oscillator manager
-    oscillatorManager = std::make_unique<WavetableOscillatorManager>(oscMgrParams, processor, *this);
+    oscillatorManager = std::make_unique<WavetableOscillatorManager>(processor, *this);
 }
 
 SynthVoice::~SynthVoice()
@@ -41,17 +41,29 @@ void SynthVoice::startNote(int midiNoteNumber, float velocity, SynthesiserSound*
 
     // Pass control to oscillator manager
     oscillatorManager->startNote(midiNoteNumber, velocity, currentPitchWheelPosition);
+
+    if (voiceAllocator != nullptr)
+    {
+        voiceAllocator->voiceStarted(voiceAllocatorIndex, midiNoteNumber);
+    }
 }
 
 void SynthVoice::stopNote(float velocity, bool allowTailOff)
 {
     // Pass control to oscillator manager
     oscillatorManager->stopNote(velocity, allowTailOff);
+
+    // A stolen voice is released here, then started again with its new note
+    if (voiceAllocator != nullptr)
+    {
+        voiceAllocator->voiceReleased(voiceAllocatorIndex);
+    }
 }
 
 void SynthVoice::pitchWheelMoved(int newPitchWheelValue)
 {
-
+    // Only stored: the bend is applied from the next block
+    oscillatorManager->pitchWheelMoved(newPitchWheelValue);
 }
 
 void SynthVoice::controllerMoved(int controllerNumber, int newControllerValue)
@@ -61,34 +73,112 @@ void SynthVoice::controllerMoved(int controllerNumber, int newControllerValue)
 
 void SynthVoice::renderNextBlock(AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
 {
-    // Check if the oscillators have a note to play
-    if (oscillatorManager->getCurrentNote() != -1)
-    {
-        // Store to avoid repeated calls
-        int numChannelsOut = outputBuffer.getNumChannels();
+    // Scratch buffer must have been sized by prepareToPlay
+    jassert(voiceBuffer.getNumSamples() > 0);
 
-        // Write pointers for each output channel
-        float** channelWritePtrs = outputBuffer.getArrayOfWritePointers();
+    // Store to avoid repeated calls
+    int numChannelsOut = outputBuffer.getNumChannels();
+    int maxBlockSize = voiceBuffer.getNumSamples();
 
-        // Index of last sample to fill in buffer
-        int stopSample = startSample + numSamples;
+    // Only pay for a second channel when something is panned
+    bool stereo = numChannelsOut > 1 && isPanned();
+
+    // Render in chunks, in case the host passes a larger block than it promised in prepareToPlay
+    while (numSamples > 0 && maxBlockSize > 0)
+    {
+        int numThisTime = jmin(numSamples, maxBlockSize);
+
+        // Render one block from the oscillatorManager, stopping once the note has ended
+        if (!renderVoiceBlock(numThisTime, stereo))
+        {
+            break;
+        }
 
-        for (int sample = startSample; sample < stopSample; ++sample)
+        // Add the block to every output channel, alternating sides in stereo
+        for (int channel = 0; channel < numChannelsOut; ++channel)
         {
-            // Get next sample from oscillatorManager
-            float nextSampleLeveled = oscillatorManager->getNextSample();
-
-            // Write sample to every output channel
-            for (int channel = 0; channel < numChannelsOut; ++channel)
-            {
-                channelWritePtrs[channel][sample] += nextSampleLeveled;
-            }
+            const float* voiceSamples = getVoiceBlock(stereo ? channel % 2 : 0);
+            FloatVectorOperations::add(outputBuffer.getWritePointer(channel, startSample), voiceSamples, numThisTime);
         }
+
+        startSample += numThisTime;
+        numSamples -= numThisTime;
+    }
+}
+
+void SynthVoice::setVoiceAllocator(VoiceAllocator* allocator, int index) noexcept
+{
+    voiceAllocator = allocator;
+    voiceAllocatorIndex = index;
+}
+
+float SynthVoice::getCurrentLevel() const noexcept
+{
+    return oscillatorManager->getCurrentLevel();
+}
+
+void SynthVoice::applyOscillatorSet(const OscillatorSet& set)
+{
+    oscillatorManager->applyOscillatorSet(set);
+}
+
+bool SynthVoice::renderVoiceBlock(int numSamples, bool stereo)
+{
+    // Check if the oscillators have a note to play
+    if (oscillatorManager->getCurrentNote() == -1)
+    {
+        return false;
+    }
+
+    jassert(numSamples <= voiceBuffer.getNumSamples());
+
+    float* left = voiceBuffer.getWritePointer(0);
+    float* right = stereo ? voiceBuffer.getWritePointer(1) : nullptr;
+
+    FloatVectorOperations::clear(left, numSamples);
+
+    if (right != nullptr)
+    {
+        FloatVectorOperations::clear(right, numSamples);
     }
+
+    oscillatorManager->renderBlock(left, right, numSamples);
+
+    return true;
+}
+
+const float* SynthVoice::getVoiceBlock(int channel) const noexcept
+{
+    return voiceBuffer.getReadPointer(channel);
+}
+
+bool SynthVoice::isPanned()
+{
+    return oscillatorManager->getCurrentNote() != -1 && oscillatorManager->isPanned();
 }
 
 //==================================================================================
 
+void SynthVoice::prepareToPlay(double sampleRate, int maximumBlockSize)
+{
+    voiceBuffer.setSize(2, maximumBlockSize, false, false, true);
+
+    oscillatorManager->setSampleRate(sampleRate);
+    oscillatorManager->setMaximumBlockSize(maximumBlockSize);
+}
+
+#if SYNTHFRAMEWORK_SSE_LANES
+bool SynthVoice::addToLanes(OscillatorLanes& lanes, int numSamples)
+{
+    return oscillatorManager->addToLanes(lanes, numSamples);
+}
+
+void SynthVoice::finishLanes()
+{
+    oscillatorManager->finishBlock();
+}
+#endif
+
 void SynthVoice::clear()
 {
     clearCurrentNote();
@@ -14,13 +14,16 @@
 #include "Common.h"
 #include "PluginProcessor.h"
 #include "SynthSound.h"
+#include "OscillatorLanes.h"
+#include "OscillatorSet.h"
+#include "VoiceAllocator.h"
 
 class WavetableOscillatorManager;
 // Plays a wavetable described by SynthSound
 class SynthVoice : public SynthesiserVoice
 {
 public:
-    SynthVoice(ValueTree oscMgrParams, SynthFrameworkAudioProcessor& p);
+    SynthVoice(SynthFrameworkAudioProcessor& p);
 
     ~SynthVoice();
 
@@ -37,6 +40,59 @@ public:
     void renderNextBlock(AudioBuffer<float>& outputBuffer, int startSample, int numSamples);
 
     //==============================================================================
+    /** Prepares the voice's scratch buffers for blocks of up to maximumBlockSize samples.
+
+        Called by the processor from prepareToPlay.
+    */
+    void prepareToPlay(double sampleRate, int maximumBlockSize);
+
+    /** Sets the allocator the voice reports its notes starting and being released to, and its index there.
+
+        Called by the synthesiser from prepareToPlay.
+    */
+    void setVoiceAllocator(VoiceAllocator* allocator, int index) noexcept;
+
+    /** Returns the current level of the voice's gain envelope, including velocity.
+
+    */
+    float getCurrentLevel() const noexcept;
+
+    /** Brings the voice's oscillators in line with set. Audio thread, at the start of a block.
+
+    */
+    void applyOscillatorSet(const OscillatorSet& set);
+
+    /** Renders the next numSamples into the voice's own buffer, replacing its contents.
+
+        Renders one channel, or two if stereo is true. Returns false, leaving the buffer untouched,
+        if the voice had nothing to play. numSamples must not exceed the size passed to prepareToPlay.
+    */
+    bool renderVoiceBlock(int numSamples, bool stereo);
+
+    /** Returns a channel of the block written by the last successful call to renderVoiceBlock.
+
+    */
+    const float* getVoiceBlock(int channel) const noexcept;
+
+    /** Returns true if any of the voice's oscillators are panned, so it should be rendered in stereo.
+
+    */
+    bool isPanned();
+
+   #if SYNTHFRAMEWORK_SSE_LANES
+    /** Adds a lane for each of this voice's playing oscillators, to be rendered alongside other voices'.
+
+        Returns true if the voice added anything, in which case finishLanes must be called once the lanes have been rendered.
+        numSamples must not exceed the size passed to prepareToPlay.
+    */
+    bool addToLanes(OscillatorLanes& lanes, int numSamples);
+
+    /** Finishes a block started by addToLanes, ending the note if its release has completed.
+
+    */
+    void finishLanes();
+   #endif
+
 
     /** Call to clear a synth voice's current note externally.
     
@@ -51,5 +107,13 @@ private:
     // the output of multiple oscillators, including fading between notes when necessary
     std::unique_ptr<WavetableOscillatorManager> oscillatorManager;
 
+    // The synthesiser's allocator, kept up to date as notes start and are released
+    VoiceAllocator* voiceAllocator = nullptr;
+    int voiceAllocatorIndex = -1;
+
+    // Scratch buffer the oscillator manager renders into before being copied to the output channels.
+    // Only the first channel is used unless an oscillator is panned
+    AudioBuffer<float> voiceBuffer;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SynthVoice)
 };
\ No newline at end of file
@@ -0,0 +1,552 @@
+/*
+  ==============================================================================
+
+    VoiceAllocator.h
+    Created: 18 Oct 2026 6:21:44am
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+
+/** Which voice is taken when a note needs one and every voice is busy. Compiled from IDs::voiceStealPolicy.
+
+    The oldest and lowest-note policies take a released voice before one whose key is still held, as Synthesiser
+    does. The quietest goes by level alone, which usually finds a released voice anyway.
+*/
+enum class VoiceStealPolicy
+{
+    // The voice that started or was released longest ago
+    oldest,
+
+    // The voice with the lowest level, as of the last block rendered
+    quietest,
+
+    // The oldest voice, unless it's playing the lowest held note, which is kept as the bass of a chord
+    lowestNoteProtected
+};
+
+//==================================================================================
+/** Chooses voices for new notes without scanning every voice, so the cost of a note on doesn't grow with polyphony.
+
+    Voices are referred to by index, and each is always in exactly one of three intrusive lists: free, held
+    (playing with its key down) and released. Held and released voices are kept in the order they joined their
+    list, so the oldest of each is at its head. Finding a free voice, or the oldest to steal, is then O(1).
+
+    For the quietest policy, active voices are also kept in a min-heap keyed by envelope level. Levels move every
+    sample, so the heap is rebuilt from fresh levels by updateActiveVoices once a block, in time linear in the
+    active voices, the same as rendering them. A voice that starts a note leaves the heap in O(log n), as its new
+    level isn't known until the next block.
+
+    Audio thread only. Nothing allocates after prepare.
+*/
+class VoiceAllocator
+{
+public:
+    // Notes that can be tracked for lowest-note protection
+    static constexpr int numNotes = 128;
+
+    VoiceAllocator() = default;
+
+    //==============================================================================
+    /** Makes room for numVoices voices, all of them free. Not for use on the audio thread.
+
+    */
+    void prepare(int numVoices)
+    {
+        voices.assign((size_t)numVoices, Voice());
+        quietHeap.clear();
+        quietHeap.reserve((size_t)numVoices);
+
+        freeVoices = List();
+        heldVoices = List();
+        releasedVoices = List();
+
+        heldNoteCounts.fill(0);
+        heldNoteBits.fill(0);
+
+        for (int i = 0; i < numVoices; ++i)
+        {
+            append(freeVoices, i);
+        }
+    }
+
+    int getNumVoices() const noexcept
+    {
+        return (int)voices.size();
+    }
+
+    int getNumActiveVoices() const noexcept
+    {
+        return heldVoices.size + releasedVoices.size;
+    }
+
+    bool isVoiceActive(int index) const noexcept
+    {
+        return voices[(size_t)index].state != State::free;
+    }
+
+    void setStealPolicy(VoiceStealPolicy newPolicy) noexcept
+    {
+        stealPolicy = newPolicy;
+    }
+
+    VoiceStealPolicy getStealPolicy() const noexcept
+    {
+        return stealPolicy;
+    }
+
+    // ============================
+    // ====== EVENT HANDLING ======
+    // ============================
+    /** Marks a voice as playing note with its key held, whatever it was doing before, making it the youngest voice.
+
+    */
+    void voiceStarted(int index, int note) noexcept
+    {
+        jassert(isPositiveAndBelow(index, getNumVoices()));
+
+        leaveState(index);
+
+        Voice& voice = voices[(size_t)index];
+        voice.state = State::held;
+        voice.note = jlimit(0, numNotes - 1, note);
+        voice.level = 0.0f;
+
+        append(heldVoices, index);
+        addHeldNote(voice.note);
+    }
+
+    /** Marks a held voice as released. Does nothing to a voice that's free or already released.
+
+    */
+    void voiceReleased(int index) noexcept
+    {
+        jassert(isPositiveAndBelow(index, getNumVoices()));
+
+        if (voices[(size_t)index].state != State::held)
+        {
+            return;
+        }
+
+        // Stays in the heap, with the level it already has
+        unlink(heldVoices, index);
+        removeHeldNote(voices[(size_t)index].note);
+
+        voices[(size_t)index].state = State::released;
+        append(releasedVoices, index);
+    }
+
+    /** Marks a voice as free, once its note has ended.
+
+    */
+    void voiceFinished(int index) noexcept
+    {
+        jassert(isPositiveAndBelow(index, getNumVoices()));
+
+        if (voices[(size_t)index].state == State::free)
+        {
+            return;
+        }
+
+        leaveState(index);
+
+        voices[(size_t)index].state = State::free;
+        append(freeVoices, index);
+    }
+
+    /** Calls function with the index of every active voice: held voices from the oldest, then released voices from the oldest.
+
+        function must not start, release or finish any voice.
+    */
+    template <typename Function>
+    void forEachActiveVoice(Function&& function) const
+    {
+        for (const List* list : { &heldVoices, &releasedVoices })
+        {
+            for (int index = list->head; index >= 0; index = voices[(size_t)index].next)
+            {
+                function(index);
+            }
+        }
+    }
+
+    /** Calls getLevel with the index of every active voice, once a block after rendering.
+
+        getLevel returns the voice's current envelope level, or a negative level if its note has ended, which frees it.
+    */
+    template <typename LevelFunction>
+    void updateActiveVoices(LevelFunction&& getLevel)
+    {
+        for (List* list : { &heldVoices, &releasedVoices })
+        {
+            for (int index = list->head; index >= 0;)
+            {
+                // Read before the voice can move to the free list
+                int next = voices[(size_t)index].next;
+                float level = getLevel(index);
+
+                if (level < 0.0f)
+                {
+                    voiceFinished(index);
+                }
+                else
+                {
+                    voices[(size_t)index].level = level;
+                }
+
+                index = next;
+            }
+        }
+
+        rebuildQuietHeap();
+    }
+
+    // ==========================
+    // ====== VOICE CHOICE ======
+    // ==========================
+    /** Returns a free voice, or -1 if every voice is active.
+
+    */
+    int findFreeVoice() const noexcept
+    {
+        return freeVoices.head;
+    }
+
+    /** Returns the voice the steal policy would take, or -1 if no voice is active.
+
+    */
+    int findVoiceToSteal() const noexcept
+    {
+        switch (stealPolicy)
+        {
+            case VoiceStealPolicy::quietest:
+            {
+                // Voices started since the last block aren't in the heap. If every voice has, the oldest is taken
+                if (!quietHeap.empty())
+                {
+                    return quietHeap.front();
+                }
+
+                break;
+            }
+
+            case VoiceStealPolicy::lowestNoteProtected:
+            {
+                if (releasedVoices.head >= 0)
+                {
+                    return releasedVoices.head;
+                }
+
+                int lowestNote = getLowestHeldNote();
+
+                // Usually the first or second voice. Only voices sharing the lowest note are ever skipped
+                for (int index = heldVoices.head; index >= 0; index = voices[(size_t)index].next)
+                {
+                    if (voices[(size_t)index].note != lowestNote)
+                    {
+                        return index;
+                    }
+                }
+
+                break;
+            }
+
+            case VoiceStealPolicy::oldest:
+            default:
+                break;
+        }
+
+        return releasedVoices.head >= 0 ? releasedVoices.head : heldVoices.head;
+    }
+
+    /** Returns the lowest note held by any voice, or -1 if no voice is held.
+
+    */
+    int getLowestHeldNote() const noexcept
+    {
+        if (heldNoteBits[0] != 0)
+        {
+            return countTrailingZeros(heldNoteBits[0]);
+        }
+
+        if (heldNoteBits[1] != 0)
+        {
+            return 64 + countTrailingZeros(heldNoteBits[1]);
+        }
+
+        return -1;
+    }
+
+private:
+    enum class State : uint8
+    {
+        free,
+        held,
+        released
+    };
+
+    struct Voice
+    {
+        State state = State::free;
+        int note = -1;
+        float level = 0.0f;
+
+        // Neighbours in the voice's list, or -1 at either end
+        int previous = -1;
+        int next = -1;
+
+        // Where the voice is in quietHeap, or -1 if it isn't
+        int heapPosition = -1;
+    };
+
+    struct List
+    {
+        int head = -1;
+        int tail = -1;
+        int size = 0;
+    };
+
+    std::vector<Voice> voices;
+
+    List freeVoices;
+    List heldVoices;
+    List releasedVoices;
+
+    VoiceStealPolicy stealPolicy = VoiceStealPolicy::oldest;
+
+    // Active voices by level, quietest first. Only kept for the quietest policy
+    std::vector<int> quietHeap;
+
+    // How many held voices are playing each note, and a bit for every note with any, so the lowest is found in one instruction
+    std::array<uint16, numNotes> heldNoteCounts {};
+    std::array<uint64, 2> heldNoteBits {};
+
+    //==============================================================================
+    static int countTrailingZeros(uint64 bits) noexcept
+    {
+       #if JUCE_MSVC
+        unsigned long index;
+        _BitScanForward64(&index, bits);
+        return (int)index;
+       #else
+        return __builtin_ctzll(bits);
+       #endif
+    }
+
+    // Takes a voice out of whichever list and heap it's in, ready to join another
+    void leaveState(int index) noexcept
+    {
+        Voice& voice = voices[(size_t)index];
+
+        switch (voice.state)
+        {
+            case State::held:
+                unlink(heldVoices, index);
+                removeHeldNote(voice.note);
+                break;
+
+            case State::released:
+                unlink(releasedVoices, index);
+                break;
+
+            case State::free:
+            default:
+                unlink(freeVoices, index);
+                break;
+        }
+
+        removeFromQuietHeap(index);
+    }
+
+    void addHeldNote(int note) noexcept
+    {
+        if (heldNoteCounts[(size_t)note]++ == 0)
+        {
+            heldNoteBits[(size_t)(note >> 6)] |= (uint64)1 << (note & 63);
+        }
+    }
+
+    void removeHeldNote(int note) noexcept
+    {
+        jassert(heldNoteCounts[(size_t)note] > 0);
+
+        if (--heldNoteCounts[(size_t)note] == 0)
+        {
+            heldNoteBits[(size_t)(note >> 6)] &= ~((uint64)1 << (note & 63));
+        }
+    }
+
+    // =========================
+    // ====== VOICE LISTS ======
+    // =========================
+    void append(List& list, int index) noexcept
+    {
+        Voice& voice = voices[(size_t)index];
+        voice.previous = list.tail;
+        voice.next = -1;
+
+        if (list.tail >= 0)
+        {
+            voices[(size_t)list.tail].next = index;
+        }
+        else
+        {
+            list.head = index;
+        }
+
+        list.tail = index;
+        ++list.size;
+    }
+
+    void unlink(List& list, int index) noexcept
+    {
+        Voice& voice = voices[(size_t)index];
+
+        if (voice.previous >= 0)
+        {
+            voices[(size_t)voice.previous].next = voice.next;
+        }
+        else
+        {
+            list.head = voice.next;
+        }
+
+        if (voice.next >= 0)
+        {
+            voices[(size_t)voice.next].previous = voice.previous;
+        }
+        else
+        {
+            list.tail = voice.previous;
+        }
+
+        voice.previous = -1;
+        voice.next = -1;
+        --list.size;
+    }
+
+    // ========================
+    // ====== QUIET HEAP ======
+    // ========================
+    bool isQuieter(int a, int b) const noexcept
+    {
+        return voices[(size_t)a].level < voices[(size_t)b].level;
+    }
+
+    void placeInHeap(int position, int index) noexcept
+    {
+        quietHeap[(size_t)position] = index;
+        voices[(size_t)index].heapPosition = position;
+    }
+
+    void siftUp(int position) noexcept
+    {
+        int index = quietHeap[(size_t)position];
+
+        while (position > 0)
+        {
+            int parent = (position - 1) / 2;
+
+            if (!isQuieter(index, quietHeap[(size_t)parent]))
+            {
+                break;
+            }
+
+            placeInHeap(position, quietHeap[(size_t)parent]);
+            position = parent;
+        }
+
+        placeInHeap(position, index);
+    }
+
+    void siftDown(int position) noexcept
+    {
+        int size = (int)quietHeap.size();
+        int index = quietHeap[(size_t)position];
+
+        for (;;)
+        {
+            int child = position * 2 + 1;
+
+            if (child >= size)
+            {
+                break;
+            }
+
+            if (child + 1 < size && isQuieter(quietHeap[(size_t)child + 1], quietHeap[(size_t)child]))
+            {
+                ++child;
+            }
+
+            if (!isQuieter(quietHeap[(size_t)child], index))
+            {
+                break;
+            }
+
+            placeInHeap(position, quietHeap[(size_t)child]);
+            position = child;
+        }
+
+        placeInHeap(position, index);
+    }
+
+    void removeFromQuietHeap(int index) noexcept
+    {
+        int position = voices[(size_t)index].heapPosition;
+
+        if (position < 0)
+        {
+            return;
+        }
+
+        voices[(size_t)index].heapPosition = -1;
+
+        int last = quietHeap.back();
+        quietHeap.pop_back();
+
+        if (last != index)
+        {
+            // The last voice fills the gap, then moves whichever way restores the order
+            placeInHeap(position, last);
+            siftDown(position);
+            siftUp(voices[(size_t)last].heapPosition);
+        }
+    }
+
+    void rebuildQuietHeap() noexcept
+    {
+        for (int index : quietHeap)
+        {
+            voices[(size_t)index].heapPosition = -1;
+        }
+
+        quietHeap.clear();
+
+        if (stealPolicy != VoiceStealPolicy::quietest)
+        {
+            return;
+        }
+
+        for (const List* list : { &heldVoices, &releasedVoices })
+        {
+            for (int index = list->head; index >= 0; index = voices[(size_t)index].next)
+            {
+                quietHeap.push_back(index);
+                voices[(size_t)index].heapPosition = (int)quietHeap.size() - 1;
+            }
+        }
+
+        for (int position = (int)quietHeap.size() / 2 - 1; position >= 0; --position)
+        {
+            siftDown(position);
+        }
+    }
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VoiceAllocator)
+};
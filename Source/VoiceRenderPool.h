@@ -0,0 +1,295 @@
+/*
+  ==============================================================================
+
+    VoiceRenderPool.h
+    Created: 17 Oct 2026 4:58:30pm
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Common.h"
+
+
+/** A fixed pool of real-time worker threads that share out numbered work items, such as voices, with work stealing.
+
+    run() splits the items into one contiguous range per thread, counting the calling thread as one of them.
+    Each thread works through its own range first, then steals the remaining items from other ranges. Ranges
+    are single 64-bit atomics, so claiming an item is one compare-and-swap, and nothing in run() allocates.
+    Idle workers watch an atomic generation counter, spinning briefly so further calls within the same block
+    are picked up at once, then block on their thread's event. run() only signals workers that have gone to
+    sleep, so a pool that isn't being used costs no CPU at all. The calling thread does any work the workers
+    don't get to, so a late worker only costs speed, never correctness.
+
+    Which thread renders an item isn't fixed, so each item should write to its own output for the result to
+    be deterministic.
+*/
+class VoiceRenderPool
+{
+public:
+    /** Work that can be shared out by the pool.
+
+    */
+    struct Task
+    {
+        virtual ~Task() = default;
+
+        /** Performs item number index. Called from the calling thread or any worker, at most once per item.
+
+        */
+        virtual void renderItem(int index) noexcept = 0;
+    };
+
+    // Most worker threads a pool can run, not counting the thread calling run()
+    static constexpr int maxWorkers = 15;
+
+    VoiceRenderPool() = default;
+
+    ~VoiceRenderPool()
+    {
+        setNumWorkers(0);
+    }
+
+    //==============================================================================
+    /** Stops any running workers and starts numWorkers new ones at real-time priority.
+
+        Must not be called while run() may be in progress, e.g. call it from prepareToPlay.
+    */
+    void setNumWorkers(int numWorkers)
+    {
+        numWorkers = jlimit(0, maxWorkers, numWorkers);
+
+        if (numWorkers == (int)workers.size())
+        {
+            return;
+        }
+
+        // Woken as well, so sleeping workers all exit together
+        for (auto& worker : workers)
+        {
+            worker->signalThreadShouldExit();
+            worker->notify();
+        }
+
+        for (auto& worker : workers)
+        {
+            worker->stopThread(1000);
+        }
+
+        workers.clear();
+
+        for (int p = 0; p <= maxWorkers; ++p)
+        {
+            partitions[p].range.store(0, std::memory_order_relaxed);
+        }
+
+        numPartitions = numWorkers + 1;
+
+        for (int i = 0; i < numWorkers; ++i)
+        {
+            // Partition 0 belongs to the calling thread
+            workers.push_back(std::make_unique<Worker>(*this, i + 1));
+            workers.back()->startThread(Thread::realtimeAudioPriority);
+        }
+    }
+
+    int getNumWorkers() const noexcept
+    {
+        return numPartitions - 1;
+    }
+
+    //==============================================================================
+    /** Performs items 0 to numItems - 1 of task across the calling thread and the workers, returning once all are done.
+
+        Safe to call from the audio thread.
+    */
+    void run(Task& task, int numItems) noexcept
+    {
+        if (numItems <= 0)
+        {
+            return;
+        }
+
+        currentTask.store(&task, std::memory_order_relaxed);
+        pending.store(numItems, std::memory_order_relaxed);
+
+        // Releasing each range publishes the task to any thread that claims from it
+        for (int p = 0; p < numPartitions; ++p)
+        {
+            uint32 first = (uint32)(numItems * p / numPartitions);
+            uint32 last = (uint32)(numItems * (p + 1) / numPartitions);
+
+            partitions[p].range.store(packRange(first, last), std::memory_order_release);
+        }
+
+        // Sequentially consistent, so a worker going to sleep either sees the new generation or is seen sleeping
+        generation.fetch_add(1, std::memory_order_seq_cst);
+
+        for (auto& worker : workers)
+        {
+            worker->wakeIfSleeping();
+        }
+
+        // Work alongside the workers, then wait for items they are still rendering
+        while (pending.load(std::memory_order_acquire) > 0)
+        {
+            runNextItem(0);
+        }
+    }
+
+private:
+    //==============================================================================
+    /** A real-time thread that renders items whenever a new generation of work is published.
+
+    */
+    class Worker : public Thread
+    {
+    public:
+        Worker(VoiceRenderPool& p, int partitionIndex)
+            : Thread("Voice render worker"),
+              pool (p),
+              partition (partitionIndex)
+        {
+        }
+
+        void run() override
+        {
+            uint32 lastGeneration = pool.generation.load(std::memory_order_acquire);
+            int idleCount = 0;
+
+            while (!threadShouldExit())
+            {
+                if (pool.runNextItem(partition))
+                {
+                    idleCount = 0;
+                    continue;
+                }
+
+                uint32 currentGeneration = pool.generation.load(std::memory_order_acquire);
+
+                if (currentGeneration != lastGeneration)
+                {
+                    lastGeneration = currentGeneration;
+                    idleCount = 0;
+                    continue;
+                }
+
+                // Spin briefly, as run() is often called again within the block, then sleep until it next is
+                if (++idleCount < spinCount)
+                {
+                    continue;
+                }
+
+                sleeping.store(true, std::memory_order_seq_cst);
+
+                if (pool.generation.load(std::memory_order_seq_cst) == lastGeneration)
+                {
+                    wait(-1);
+                }
+
+                sleeping.store(false, std::memory_order_relaxed);
+                idleCount = 0;
+            }
+        }
+
+        /** Signals the worker's event if it has gone to sleep, or is about to. Called by run() after publishing work.
+
+        */
+        void wakeIfSleeping() noexcept
+        {
+            if (sleeping.load(std::memory_order_seq_cst))
+            {
+                notify();
+            }
+        }
+
+    private:
+        static constexpr int spinCount = 2000;
+
+        VoiceRenderPool& pool;
+        int partition;
+
+        // Set while the worker is waiting on its event, or about to
+        std::atomic<bool> sleeping { false };
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Worker)
+    };
+
+    // One thread's share of the items, as (next << 32) | end. Padded to a cache line each so
+    // threads claiming from their own ranges don't contend
+    struct alignas(64) Partition
+    {
+        std::atomic<uint64> range { 0 };
+    };
+
+    std::array<Partition, maxWorkers + 1> partitions;
+    int numPartitions = 1;
+
+    std::atomic<Task*> currentTask { nullptr };
+    // Items claimed by no thread or still being rendered
+    std::atomic<int> pending { 0 };
+    // Bumped once per run(), so idle workers know to look for work
+    std::atomic<uint32> generation { 0 };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    //==============================================================================
+    static uint64 packRange(uint32 next, uint32 end) noexcept
+    {
+        return ((uint64)next << 32) | (uint64)end;
+    }
+
+    /** Claims the next item from a partition, returning false if it has none left.
+
+    */
+    bool claimItem(int partition, int& item) noexcept
+    {
+        std::atomic<uint64>& range = partitions[partition].range;
+        uint64 current = range.load(std::memory_order_acquire);
+
+        for (;;)
+        {
+            uint32 next = (uint32)(current >> 32);
+            uint32 end = (uint32)current;
+
+            if (next >= end)
+            {
+                return false;
+            }
+
+            if (range.compare_exchange_weak(current, packRange(next + 1, end), std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                item = (int)next;
+                return true;
+            }
+        }
+    }
+
+    /** Renders one item, taken from homePartition if it has any and stolen from the other partitions if not.
+
+        Returns false if there was nothing left to claim.
+    */
+    bool runNextItem(int homePartition) noexcept
+    {
+        for (int i = 0; i < numPartitions; ++i)
+        {
+            int partition = (homePartition + i) % numPartitions;
+            int item;
+
+            if (claimItem(partition, item))
+            {
+                currentTask.load(std::memory_order_acquire)->renderItem(item);
+                pending.fetch_sub(1, std::memory_order_release);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VoiceRenderPool)
+};
@@ -0,0 +1,307 @@
+/*
+  ==============================================================================
+
+    WavetableCache.cpp
+    Created: 17 Oct 2026 8:21:14pm
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#include "WavetableCache.h"
+
+constexpr char WavetableCache::magic[8];
+
+File WavetableCache::getCacheFile(const String& setName, unsigned int tableSize)
+{
+    return File::getSpecialLocation(File::userApplicationDataDirectory)
+               .getChildFile("SynthFramework")
+               .getChildFile("Cache")
+               .getChildFile(setName + "-" + String((int)tableSize) + ".sfwt");
+}
+
+//==============================================================================
+std::vector<std::unique_ptr<MipmappedWavetable>> WavetableCache::load(const File& file,
+                                                                      unsigned int tableSize,
+                                                                      int numTables,
+                                                                      uint32 contentVersion)
+{
+    std::vector<std::unique_ptr<MipmappedWavetable>> tables;
+
+    if (!file.existsAsFile())
+    {
+        return tables;
+    }
+
+    // Shared by every chain loaded from it, so the file stays mapped until the last one is freed
+    auto mappedFile = std::make_shared<MemoryMappedFile>(file, MemoryMappedFile::readOnly);
+
+    const char* fileData = static_cast<const char*>(mappedFile->getData());
+    size_t fileSize = mappedFile->getSize();
+
+    if (fileData == nullptr || fileSize < sizeof(Header))
+    {
+        return tables;
+    }
+
+    // ===========================
+    // ====== VALIDATE FILE ======
+    // ===========================
+    Header header;
+    std::memcpy(&header, fileData, sizeof(Header));
+
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0
+        || header.formatVersion != formatVersion
+        || header.contentVersion != contentVersion
+        || header.tableSize != tableSize
+        || header.numTables != (uint32)numTables
+        || header.numFrames == 0
+        || header.sampleFormat != (uint32)WavetableSampleFormat::float32
+        || header.numLevels == 0
+        || header.payloadSize != fileSize - sizeof(Header))
+    {
+        return tables;
+    }
+
+    size_t dataOffset = getDataOffset(header.numLevels, header.numTables);
+
+    if (dataOffset > fileSize)
+    {
+        return tables;
+    }
+
+    std::vector<LevelEntry> levels(header.numLevels);
+    std::memcpy(levels.data(), fileData + sizeof(Header), sizeof(LevelEntry) * levels.size());
+
+    std::vector<uint64> levelChecksums((size_t)header.numLevels * header.numTables);
+    std::memcpy(levelChecksums.data(), fileData + sizeof(Header) + sizeof(LevelEntry) * levels.size(), sizeof(uint64) * levelChecksums.size());
+
+    if (calculateChecksum(header, levels.data(), levelChecksums.data()) != header.checksum)
+    {
+        return tables;
+    }
+
+    // Every level must be a valid size, and all of them must fit in the file
+    size_t samplesPerTable = 0;
+
+    for (const LevelEntry& level : levels)
+    {
+        if (!isPowerOfTwo(level.size) || level.harmonics == 0
+            || level.frameStride < (uint32)(MipmappedWavetable::guardSamplesBefore + MipmappedWavetable::guardSamplesAfter) + level.size)
+        {
+            return tables;
+        }
+
+        samplesPerTable += (size_t)level.frameStride * header.numFrames;
+    }
+
+    if (dataOffset + samplesPerTable * (size_t)numTables * sizeof(float) > fileSize)
+    {
+        return tables;
+    }
+
+    // ===============================
+    // ====== MAP IN AND VERIFY ======
+    // ===============================
+    const float* samples = reinterpret_cast<const float*>(fileData + dataOffset);
+    const uint64* expectedChecksum = levelChecksums.data();
+
+    for (int i = 0; i < numTables; ++i)
+    {
+        auto table = std::make_unique<MipmappedWavetable>((int)header.numFrames);
+
+        for (const LevelEntry& level : levels)
+        {
+            size_t levelSamples = (size_t)level.frameStride * header.numFrames;
+
+            // Read in place, once, so a corrupt level is caught here rather than played
+            if (calculateLevelChecksum(samples, levelSamples) != *expectedChecksum++)
+            {
+                tables.clear();
+                return tables;
+            }
+
+            table->addExternalLevel(samples, (int)level.size, (int)level.harmonics, (int)level.frameStride);
+            samples += levelSamples;
+        }
+
+        table->keepStorageAlive(mappedFile);
+        tables.push_back(std::move(table));
+    }
+
+    return tables;
+}
+
+bool WavetableCache::save(const File& file,
+                          const std::vector<std::unique_ptr<MipmappedWavetable>>& tables,
+                          uint32 contentVersion)
+{
+    if (tables.empty())
+    {
+        return false;
+    }
+
+    const MipmappedWavetable& first = *tables.front();
+
+    if (first.getSampleFormat() != WavetableSampleFormat::float32)
+    {
+        jassertfalse;
+        return false;
+    }
+    uint32 numLevels = (uint32)first.getNumLevels();
+    uint32 numFrames = (uint32)first.getNumFrames();
+
+    size_t samplesPerTable = 0;
+
+    for (uint32 level = 0; level < numLevels; ++level)
+    {
+        samplesPerTable += (size_t)first.getFrameStride((int)level) * numFrames;
+    }
+
+    // =============================
+    // ====== BUILD DIRECTORY ======
+    // =============================
+    std::vector<LevelEntry> directory(numLevels);
+
+    for (uint32 level = 0; level < numLevels; ++level)
+    {
+        directory[level] = { (uint32)first.getLevelSize((int)level),
+                             (uint32)first.getLevelHarmonics((int)level),
+                             (uint32)first.getFrameStride((int)level) };
+    }
+
+    std::vector<uint64> levelChecksums;
+    levelChecksums.reserve((size_t)numLevels * tables.size());
+
+    for (const auto& table : tables)
+    {
+        // Every table in a set shares the one directory
+        jassert(table->getNumLevels() == (int)numLevels && table->getNumFrames() == (int)numFrames);
+
+        for (uint32 level = 0; level < numLevels; ++level)
+        {
+            jassert(table->getLevelSize((int)level) == (int)directory[level].size);
+
+            levelChecksums.push_back(calculateLevelChecksum(table->getLevelStorage((int)level), (size_t)directory[level].frameStride * numFrames));
+        }
+    }
+
+    // Everything after the header: the level directory, the level checksums, padding up to the samples, then the samples
+    uint32 numTables = (uint32)tables.size();
+    size_t metadataSize = sizeof(Header) + sizeof(LevelEntry) * numLevels + sizeof(uint64) * levelChecksums.size();
+    size_t dataOffset = getDataOffset(numLevels, numTables);
+    size_t payloadSize = dataOffset - sizeof(Header) + samplesPerTable * tables.size() * sizeof(float);
+
+    Header header;
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.formatVersion = formatVersion;
+    header.contentVersion = contentVersion;
+    header.tableSize = (uint32)first.getLevelSize(0);
+    header.numTables = numTables;
+    header.numLevels = numLevels;
+    header.numFrames = numFrames;
+    header.sampleFormat = (uint32)WavetableSampleFormat::float32;
+    header.reserved = 0;
+    header.payloadSize = (uint64)payloadSize;
+    header.checksum = calculateChecksum(header, directory.data(), levelChecksums.data());
+
+    // ===================
+    // ====== WRITE ======
+    // ===================
+    if (file.getParentDirectory().createDirectory().failed())
+    {
+        return false;
+    }
+
+    // Written beside the target and moved over it, so a mapped copy is never modified in place
+    TemporaryFile tempFile(file);
+
+    {
+        FileOutputStream stream(tempFile.getFile());
+
+        if (stream.failedToOpen()
+            || !stream.write(&header, sizeof(Header))
+            || !stream.write(directory.data(), sizeof(LevelEntry) * numLevels)
+            || !stream.write(levelChecksums.data(), sizeof(uint64) * levelChecksums.size())
+            || !stream.writeRepeatedByte(0, dataOffset - metadataSize))
+        {
+            return false;
+        }
+
+        // Straight from each table, so the set is never copied in memory
+        for (const auto& table : tables)
+        {
+            for (uint32 level = 0; level < numLevels; ++level)
+            {
+                // A level's frames are contiguous, guard samples and padding included
+                size_t levelSamples = (size_t)directory[level].frameStride * numFrames;
+
+                if (!stream.write(table->getLevelStorage((int)level), sizeof(float) * levelSamples))
+                {
+                    return false;
+                }
+            }
+        }
+
+        stream.flush();
+
+        if (stream.getStatus().failed())
+        {
+            return false;
+        }
+    }
+
+    return tempFile.overwriteTargetFileWithTemporary();
+}
+
+//==============================================================================
+size_t WavetableCache::getDataOffset(uint32 numLevels, uint32 numTables) noexcept
+{
+    size_t metadataEnd = sizeof(Header) + sizeof(LevelEntry) * numLevels + sizeof(uint64) * numLevels * numTables;
+    return (metadataEnd + dataAlignment - 1) / dataAlignment * dataAlignment;
+}
+
+uint64 WavetableCache::calculateChecksum(const Header& header, const LevelEntry* directory, const uint64* levelChecksums) noexcept
+{
+    Header unchecked = header;
+    unchecked.checksum = 0;
+
+    uint64 hash = hashBytes(14695981039346656037ull, &unchecked, sizeof(Header));
+    hash = hashBytes(hash, directory, sizeof(LevelEntry) * header.numLevels);
+    return hashBytes(hash, levelChecksums, sizeof(uint64) * header.numLevels * header.numTables);
+}
+
+uint64 WavetableCache::calculateLevelChecksum(const void* samples, size_t numSamples) noexcept
+{
+    return hashWords(14695981039346656037ull, samples, sizeof(float) * numSamples);
+}
+
+uint64 WavetableCache::hashBytes(uint64 hash, const void* data, size_t numBytes) noexcept
+{
+    const uint8* bytes = static_cast<const uint8*>(data);
+
+    for (size_t i = 0; i < numBytes; ++i)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+
+    return hash;
+}
+
+uint64 WavetableCache::hashWords(uint64 hash, const void* data, size_t numBytes) noexcept
+{
+    const uint8* bytes = static_cast<const uint8*>(data);
+    size_t numWords = numBytes / sizeof(uint64);
+
+    for (size_t i = 0; i < numWords; ++i)
+    {
+        uint64 word;
+        std::memcpy(&word, bytes + i * sizeof(uint64), sizeof(uint64));
+
+        // The multiply only carries changes upwards, so the top half is folded back into the bottom each time
+        hash = (hash ^ word) * 1099511628211ull;
+        hash ^= hash >> 32;
+    }
+
+    return hashBytes(hash, bytes + numWords * sizeof(uint64), numBytes - numWords * sizeof(uint64));
+}
@@ -0,0 +1,115 @@
+/*
+  ==============================================================================
+
+    WavetableCache.h
+    Created: 17 Oct 2026 8:21:14pm
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MipmappedWavetable.h"
+
+
+/** Saves sets of generated mip chains to disk, and maps them back in so later instances don't regenerate them.
+
+    A cache file holds a fixed header, a directory of levels shared by every table in the set, a checksum for
+    each level of each table, and then the frames of each level of each table, guard samples included, at the
+    same cache-aligned stride the tables use in memory. Loaded chains read their samples straight from the
+    memory-mapped file, which stays mapped until the last of them is freed.
+
+    A file is only used if its header matches what the caller asked for, the checksum of the header, directory
+    and level checksums matches the one stored, and every level's samples hash to their checksum. Anything
+    else, whether a stale generator version, a different table size, a truncated write or corrupt samples,
+    makes load return nothing so the caller can regenerate and save again. Levels are verified once, on the
+    thread calling load, by hashing the mapped samples a word at a time, so nothing is copied and the audio
+    thread never waits on a page being read for the first time.
+*/
+class WavetableCache
+{
+public:
+    // Bump whenever the layout of the file changes
+    static constexpr uint32 formatVersion = 5;
+
+    //==============================================================================
+    /** Returns the file a named set of tables with the given top level size is cached in.
+
+    */
+    static File getCacheFile(const String& setName, unsigned int tableSize);
+
+    /** Maps a set of tables from file.
+
+        Returns numTables chains with as many frames as were saved, or an empty vector if the file is missing,
+        corrupt, or doesn't hold numTables tables of tableSize made by contentVersion of their generator.
+    */
+    static std::vector<std::unique_ptr<MipmappedWavetable>> load(const File& file,
+                                                                 unsigned int tableSize,
+                                                                 int numTables,
+                                                                 uint32 contentVersion);
+
+    /** Writes a set of tables to file, replacing it in one step so other instances never map a partial write.
+
+        Every table must have the same levels and number of frames, and be float32: compact chains are made from
+        the cached floats once loaded. Returns false if the file couldn't be written.
+    */
+    static bool save(const File& file,
+                     const std::vector<std::unique_ptr<MipmappedWavetable>>& tables,
+                     uint32 contentVersion);
+
+private:
+    //==============================================================================
+    struct Header
+    {
+        char magic[8];
+        uint32 formatVersion;
+        uint32 contentVersion;
+        uint32 tableSize;
+        uint32 numTables;
+        uint32 numLevels;
+        uint32 numFrames;
+        uint32 sampleFormat;
+        uint32 reserved;
+        uint64 payloadSize;
+        uint64 checksum;
+    };
+
+    struct LevelEntry
+    {
+        uint32 size;
+        uint32 harmonics;
+        uint32 frameStride;
+    };
+
+    static constexpr char magic[8] = { 'S', 'F', 'W', 'T', 'A', 'B', 'L', 'E' };
+
+    // Sample data starts on a boundary of this many bytes from the start of the file
+    static constexpr size_t dataAlignment = 64;
+
+    /** Returns the offset from the start of the file to the first sample of a set with numLevels levels in each of numTables tables.
+
+    */
+    static size_t getDataOffset(uint32 numLevels, uint32 numTables) noexcept;
+
+    /** 64-bit FNV-1a hash of a header, with its checksum taken as 0, the directory and the level checksums that follow it.
+
+    */
+    static uint64 calculateChecksum(const Header& header, const LevelEntry* directory, const uint64* levelChecksums) noexcept;
+
+    /** Hashes the numSamples samples of one level of one table, guard samples and padding included.
+
+    */
+    static uint64 calculateLevelChecksum(const void* samples, size_t numSamples) noexcept;
+
+    /** Continues a 64-bit FNV-1a hash over a block of bytes.
+
+    */
+    static uint64 hashBytes(uint64 hash, const void* data, size_t numBytes) noexcept;
+
+    /** Continues a 64-bit hash over a block of bytes eight at a time, FNV-1a style with each word folded back down,
+        so a whole payload hashes at close to memory speed. Any bytes past the last whole word are hashed singly.
+    */
+    static uint64 hashWords(uint64 hash, const void* data, size_t numBytes) noexcept;
+};
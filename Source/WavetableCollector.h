@@ -0,0 +1,282 @@
+/*
+  ==============================================================================
+
+    WavetableCollector.h
+    Created: 17 Oct 2026 7:05:52pm
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MipmappedWavetable.h"
+
+
+/** Owning reference to a wavetable. Held by the message thread, sounds and OscillatorSets, never the audio thread.
+
+    Releasing the last handle doesn't free the table. It is retired to the WavetableCollector that adopted it,
+    which frees it on its own thread once no render block can still be reading it.
+*/
+using WavetableHandle = std::shared_ptr<const MipmappedWavetable>;
+
+//==================================================================================
+/** Frees retired wavetables on a background thread, using epochs to tell when no block can still be reading them.
+
+    Audio threads only hold raw, non-owning pointers to tables, so reading one costs no reference counting.
+    Each thread or processor that renders registers as a reader, and brackets every block with enterBlock and exitBlock,
+    which publish the global epoch it started in. Retiring a table tags it with the current epoch and then
+    advances it. The collector frees a table once every reader is either between blocks or inside a block that
+    started after the table was retired.
+
+    A table must be unreachable by the time it is retired: no OscillatorSet or oscillator a reader could
+    pick up in a new block can still point at it. Handles guarantee this, as an OscillatorSet holds a handle
+    to each of its tables until the audio thread has moved its oscillators on to a newer set.
+
+    One collector is shared by every processor in the process, through a SharedResourcePointer, so that
+    large banks can be hot-swapped from any instance without the free landing on a message or audio thread.
+*/
+class WavetableCollector : private Thread
+{
+public:
+    /** A registered reader's record of the epoch it's rendering in.
+
+        One cache line each, so readers entering blocks on different cores don't contend.
+    */
+    struct alignas(64) Reader
+    {
+        std::atomic<uint64> epoch { idleEpoch };
+        std::atomic<bool> registered { false };
+
+        // Set before the record is added to the list, and never changed after
+        Reader* next = nullptr;
+    };
+
+    WavetableCollector()
+        : Thread("Wavetable collector")
+    {
+        startThread(1);
+    }
+
+    ~WavetableCollector()
+    {
+        stopThread(1000);
+
+        // Every reader must have unregistered, so whatever is left can be freed here
+        {
+            const ScopedLock sl(retiredLock);
+            retired.clear();
+        }
+
+        for (Reader* reader = readers.load(); reader != nullptr;)
+        {
+            Reader* next = reader->next;
+            delete reader;
+            reader = next;
+        }
+    }
+
+    //==============================================================================
+    /** Takes ownership of a new table, returning the handle that will retire it to this collector.
+
+    */
+    WavetableHandle adopt(std::unique_ptr<MipmappedWavetable> table)
+    {
+        return WavetableHandle(table.release(), [this](const MipmappedWavetable* retiredTable)
+        {
+            retire(retiredTable);
+        });
+    }
+
+    /** Returns the number of retired tables still waiting to be freed.
+
+    */
+    int getNumPendingTables() const
+    {
+        const ScopedLock sl(retiredLock);
+        return (int)retired.size();
+    }
+
+    // ============================
+    // ====== READER THREADS ======
+    // ============================
+    /** Claims a reader record for a thread or processor that renders with raw table pointers. Not audio thread.
+
+        Reuses a record released by unregisterReader if there is one, and allocates a new one if not, so there's
+        no limit on how many readers can be registered at once. Returns the record to pass to enterBlock and exitBlock.
+    */
+    Reader* registerReader()
+    {
+        for (Reader* reader = readers.load(); reader != nullptr; reader = reader->next)
+        {
+            bool expected = false;
+
+            if (reader->registered.compare_exchange_strong(expected, true))
+            {
+                reader->epoch.store(idleEpoch);
+                return reader;
+            }
+        }
+
+        // Records are only ever added, at the head, and never freed while the collector is alive,
+        // so the collector can walk the list while another is being added
+        auto* reader = new Reader();
+        reader->registered.store(true);
+        reader->next = readers.load();
+
+        while (!readers.compare_exchange_weak(reader->next, reader))
+        {
+        }
+
+        return reader;
+    }
+
+    /** Releases a record claimed by registerReader, so a later registerReader can reuse it. Not audio thread.
+
+    */
+    void unregisterReader(Reader* reader)
+    {
+        if (reader != nullptr)
+        {
+            reader->epoch.store(idleEpoch);
+            reader->registered.store(false);
+
+            notify();
+        }
+    }
+
+    /** Marks the start of a block that may read tables. Audio thread.
+
+        Wait-free: a single load and store.
+    */
+    void enterBlock(Reader* reader) noexcept
+    {
+        jassert(reader != nullptr);
+        reader->epoch.store(globalEpoch.load());
+    }
+
+    /** Marks the end of a block started by enterBlock. Audio thread.
+
+    */
+    void exitBlock(Reader* reader) noexcept
+    {
+        jassert(reader != nullptr);
+        reader->epoch.store(idleEpoch);
+    }
+
+    /** Brackets a block with enterBlock and exitBlock.
+
+    */
+    struct ScopedReader
+    {
+        ScopedReader(WavetableCollector& c, Reader* r) noexcept
+            : collector(c), reader(r)
+        {
+            collector.enterBlock(reader);
+        }
+
+        ~ScopedReader()
+        {
+            collector.exitBlock(reader);
+        }
+
+        WavetableCollector& collector;
+        Reader* const reader;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedReader)
+    };
+
+private:
+    //==============================================================================
+    static constexpr uint64 idleEpoch = std::numeric_limits<uint64>::max();
+
+    // Every record ever registered, newest first
+    std::atomic<Reader*> readers { nullptr };
+
+    std::atomic<uint64> globalEpoch { 0 };
+
+    struct RetiredTable
+    {
+        std::unique_ptr<const MipmappedWavetable> table;
+        uint64 epoch;
+    };
+
+    // Tables waiting to be freed. Shared by whichever threads release handles and the collector, never the audio thread
+    CriticalSection retiredLock;
+    std::vector<RetiredTable> retired;
+
+    // How often the collector checks for tables to free when nothing has been retired
+    static constexpr int collectIntervalMs = 500;
+
+    /** Called by a handle's deleter when its last reference is released.
+
+    */
+    void retire(const MipmappedWavetable* table)
+    {
+        {
+            const ScopedLock sl(retiredLock);
+
+            // Tag with the epoch before advancing it, so only blocks entered after this can ignore the table
+            retired.push_back({ std::unique_ptr<const MipmappedWavetable>(table), globalEpoch.fetch_add(1) });
+        }
+
+        notify();
+    }
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            collect();
+            wait(collectIntervalMs);
+        }
+    }
+
+    /** Returns the earliest epoch any reader is currently inside a block for, or idleEpoch if none are.
+
+    */
+    uint64 getOldestActiveEpoch() const noexcept
+    {
+        uint64 oldest = idleEpoch;
+
+        for (Reader* reader = readers.load(); reader != nullptr; reader = reader->next)
+        {
+            oldest = jmin(oldest, reader->epoch.load());
+        }
+
+        return oldest;
+    }
+
+    /** Frees every retired table that was retired before the oldest block still running started.
+
+    */
+    void collect()
+    {
+        uint64 oldestActive = getOldestActiveEpoch();
+
+        std::vector<RetiredTable> toFree;
+
+        {
+            const ScopedLock sl(retiredLock);
+
+            for (auto it = retired.begin(); it != retired.end();)
+            {
+                if (it->epoch < oldestActive)
+                {
+                    toFree.push_back(std::move(*it));
+                    it = retired.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+
+        // Tables are freed here outside the lock
+    }
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WavetableCollector)
+};
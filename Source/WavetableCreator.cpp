@@ -11,61 +11,394 @@
 #include <JuceHeader.h>
 #include "WavetableCreator.h"
 
-std::shared_ptr<AudioBuffer<float>> WavetableCreator::createSineTable(const unsigned int tableSize)
+std::unique_ptr<MipmappedWavetable> WavetableCreator::createSineTable(const unsigned int tableSize)
 {
-    // Instantiate new buffer contained in a shared pointer
-    std::shared_ptr<AudioBuffer<float>> table = std::make_shared<AudioBuffer<float>>(1, tableSize + 1);
+    return createMipmappedTable(tableSize, getSineSpectrum());
+}
+
+std::unique_ptr<MipmappedWavetable> WavetableCreator::createSawTable(const unsigned int tableSize)
+{
+    return createMipmappedTable(tableSize, getSawSpectrum());
+}
+
+std::unique_ptr<MipmappedWavetable> WavetableCreator::createRampTable(const unsigned int tableSize)
+{
+    return createMipmappedTable(tableSize, getRampSpectrum());
+}
+
+std::unique_ptr<MipmappedWavetable> WavetableCreator::createTriangleTable(const unsigned int tableSize)
+{
+    return createMipmappedTable(tableSize, getTriangleSpectrum());
+}
 
+std::unique_ptr<MipmappedWavetable> WavetableCreator::createSquareTable(const unsigned int tableSize)
+{
+    return createMipmappedTable(tableSize, getSquareSpectrum());
+}
 
-    auto* samples = table->getWritePointer(0);
+//==============================================================================
+WavetableCreator::HarmonicSpectrum WavetableCreator::getBaseShapeSpectrum(BaseShape shape)
+{
+    return { [shape] (int harmonic)
+    {
+        return getBaseShapeAmplitude(shape, harmonic);
+    } };
+}
+
+WavetableCreator::HarmonicSpectrum WavetableCreator::getSineSpectrum()
+{
+    return getBaseShapeSpectrum(BaseShape::sine);
+}
+
+WavetableCreator::HarmonicSpectrum WavetableCreator::getSawSpectrum()
+{
+    return getBaseShapeSpectrum(BaseShape::saw);
+}
+
+WavetableCreator::HarmonicSpectrum WavetableCreator::getRampSpectrum()
+{
+    return getBaseShapeSpectrum(BaseShape::ramp);
+}
+
+WavetableCreator::HarmonicSpectrum WavetableCreator::getTriangleSpectrum()
+{
+    return getBaseShapeSpectrum(BaseShape::triangle);
+}
+
+WavetableCreator::HarmonicSpectrum WavetableCreator::getSquareSpectrum()
+{
+    return getBaseShapeSpectrum(BaseShape::square);
+}
+
+//==============================================================================
+std::unique_ptr<MipmappedWavetable> WavetableCreator::createMipmappedTable(const unsigned int tableSize,
+                                                                          const HarmonicSpectrum& spectrum)
+{
+    return std::move(createMipmappedTables(tableSize, { spectrum }, nullptr).front());
+}
+
+std::vector<std::unique_ptr<MipmappedWavetable>> WavetableCreator::createMipmappedTables(const unsigned int tableSize,
+                                                                                        const std::vector<HarmonicSpectrum>& spectra,
+                                                                                        ThreadPool* pool)
+{
+    jassert(isPowerOfTwo(tableSize));
 
-    auto angleDelta = MathConstants<double>::twoPi / (double)(tableSize - 1);
-    auto currentAngle = 0.0;
+    std::vector<std::unique_ptr<MipmappedWavetable>> tables;
 
-    for (auto i = 0; i < tableSize; ++i)
+    // Allocate every level up front, so levels can be rendered in any order on any thread
+    for (size_t i = 0; i < spectra.size(); ++i)
     {
-        auto sample = std::sin(currentAngle);
-        samples[i] = (float) sample;
-        currentAngle += angleDelta;
+        tables.push_back(std::make_unique<MipmappedWavetable>());
+        addLevels(*tables.back(), (int)tableSize);
     }
 
-    // Wraparound: last sample is equal to first
-    samples[tableSize] = samples[0];
+    if (tables.empty())
+    {
+        return tables;
+    }
+
+    std::vector<LevelJob> jobs;
 
-    return std::move(table);
+    for (size_t i = 0; i < tables.size(); ++i)
+    {
+        for (int level = 0; level < tables[i]->getNumLevels(); ++level)
+        {
+            jobs.push_back({ tables[i].get(), level, 0, &spectra[i] });
+        }
+    }
+
+    renderLevels(jobs, pool);
+
+    for (auto& table : tables)
+    {
+        normaliseLevels(*table);
+    }
+
+    return tables;
 }
 
-std::shared_ptr<AudioBuffer<float>> WavetableCreator::createSawTable(const unsigned int tableSize)
+std::unique_ptr<MipmappedWavetable> WavetableCreator::createMultiFrameTable(const unsigned int tableSize,
+                                                                           const std::vector<HarmonicSpectrum>& frameSpectra,
+                                                                           ThreadPool* pool)
 {
-    // Instantiate new buffer contained in a shared pointer
-    std::shared_ptr<AudioBuffer<float>> table = std::make_shared<AudioBuffer<float>>(1, tableSize + 1);
+    jassert(isPowerOfTwo(tableSize));
+    jassert(!frameSpectra.empty());
+
+    auto table = std::make_unique<MipmappedWavetable>(jmax(1, (int)frameSpectra.size()));
+    addLevels(*table, (int)tableSize);
+
+    std::vector<LevelJob> jobs;
+
+    for (int level = 0; level < table->getNumLevels(); ++level)
+    {
+        for (size_t frame = 0; frame < frameSpectra.size(); ++frame)
+        {
+            jobs.push_back({ table.get(), level, (int)frame, &frameSpectra[frame] });
+        }
+    }
 
+    renderLevels(jobs, pool);
+    normaliseLevels(*table);
 
-    return std::move(table);
+    return table;
 }
 
-std::shared_ptr<AudioBuffer<float>> WavetableCreator::createRampTable(const unsigned int tableSize)
+std::unique_ptr<MipmappedWavetable> WavetableCreator::createEmptyTable(const unsigned int tableSize, int numFrames)
 {
-    // Instantiate new buffer contained in a shared pointer
-    std::shared_ptr<AudioBuffer<float>> table = std::make_shared<AudioBuffer<float>>(1, tableSize + 1);
+    jassert(isPowerOfTwo(tableSize));
 
+    auto table = std::make_unique<MipmappedWavetable>(jmax(1, numFrames));
+    addLevels(*table, (int)tableSize);
 
-    return std::move(table);
+    return table;
 }
 
-std::shared_ptr<AudioBuffer<float>> WavetableCreator::createTriangleTable(const unsigned int tableSize)
+void WavetableCreator::renderFramesFromCycles(MipmappedWavetable& table, int firstFrame, const float* cycles, int numCycles, ThreadPool* pool)
 {
-    // Instantiate new buffer contained in a shared pointer
-    std::shared_ptr<AudioBuffer<float>> table = std::make_shared<AudioBuffer<float>>(1, tableSize + 1);
+    jassert(firstFrame >= 0 && firstFrame + numCycles <= table.getNumFrames());
+
+    int cycleSize = table.getLevelSize(0);
+
+    // One transform per level size, shared by every cycle: performing a transform doesn't modify it
+    std::vector<std::unique_ptr<dsp::FFT>> ffts;
 
+    for (int level = 0; level < table.getNumLevels(); ++level)
+    {
+        ffts.push_back(std::make_unique<dsp::FFT>(getFFTOrder(table.getLevelSize(level))));
+    }
+
+    runJobs(numCycles, [&] (int cycle)
+    {
+        // Real-only transforms work in place on twice the transform size
+        std::vector<float> spectrum((size_t)cycleSize * 2, 0.0f);
+        std::vector<float> bins((size_t)cycleSize * 2);
+
+        FloatVectorOperations::copy(spectrum.data(), cycles + (size_t)cycle * (size_t)cycleSize, cycleSize);
+        ffts[0]->performRealOnlyForwardTransform(spectrum.data(), true);
 
-    return std::move(table);
+        for (int level = 0; level < table.getNumLevels(); ++level)
+        {
+            int levelSize = table.getLevelSize(level);
+            int maxHarmonic = table.getLevelHarmonics(level);
+
+            // The inverse transform of a smaller level is scaled by 1 / levelSize rather than 1 / cycleSize.
+            // DC and everything above the level's highest harmonic are left out
+            std::fill(bins.begin(), bins.begin() + levelSize * 2, 0.0f);
+            FloatVectorOperations::copyWithMultiply(bins.data() + 2, spectrum.data() + 2,
+                                                    (float)levelSize / (float)cycleSize, maxHarmonic * 2);
+
+            ffts[(size_t)level]->performRealOnlyInverseTransform(bins.data());
+
+            FloatVectorOperations::copy(table.getLevelWritePointer(level, firstFrame + cycle), bins.data(), levelSize);
+        }
+    }, pool);
 }
 
-std::shared_ptr<AudioBuffer<float>> WavetableCreator::createSquareTable(const unsigned int tableSize)
+//==============================================================================
+std::unique_ptr<MipmappedWavetable> WavetableCreator::createCompactTable(const MipmappedWavetable& source, WavetableSampleFormat format)
 {
-    // Instantiate new buffer contained in a shared pointer
-    std::shared_ptr<AudioBuffer<float>> table = std::make_shared<AudioBuffer<float>>(1, tableSize + 1);
+    jassert(source.getSampleFormat() == WavetableSampleFormat::float32);
+
+    auto table = std::make_unique<MipmappedWavetable>(source.getNumFrames(), format);
+
+    for (int level = 0; level < source.getNumLevels(); ++level)
+    {
+        table->addLevel(source.getLevelSize(level), source.getLevelHarmonics(level));
+    }
+
+    for (int level = 0; level < source.getNumLevels(); ++level)
+    {
+        int numSamples = source.getLevelSize(level);
+
+        for (int frame = 0; frame < source.getNumFrames(); ++frame)
+        {
+            const float* samples = source.getLevelReadPointer(level, frame);
+
+            auto range = FloatVectorOperations::findMinAndMax(samples, numSamples);
+            float peak = jmax(std::abs(range.getStart()), std::abs(range.getEnd()));
+
+            if (format == WavetableSampleFormat::int16)
+            {
+                float scale = peak > 0.0f ? peak / 32767.0f : 1.0f;
+                int16* dest = table->getLevelSamplesForWriting<int16>(level, frame);
 
-    return std::move(table);
-}
\ No newline at end of file
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    dest[i] = (int16)jlimit(-32767, 32767, roundToInt(samples[i] / scale));
+                }
+
+                table->setFrameScale(level, frame, scale);
+            }
+            else if (format == WavetableSampleFormat::float16)
+            {
+                float scale = peak > 0.0f ? peak : 1.0f;
+                uint16* dest = table->getLevelSamplesForWriting<uint16>(level, frame);
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    dest[i] = floatToHalf(samples[i] / scale);
+                }
+
+                table->setFrameScale(level, frame, scale);
+            }
+            else
+            {
+                FloatVectorOperations::copy(table->getLevelWritePointer(level, frame), samples, numSamples);
+            }
+
+            table->fillGuardSamples(level, frame);
+        }
+    }
+
+    return table;
+}
+
+//==============================================================================
+void WavetableCreator::renderLevels(std::vector<LevelJob>& jobs, ThreadPool* pool)
+{
+    // Hand out the largest FFTs first, so the last jobs to finish are the quickest
+    std::stable_sort(jobs.begin(), jobs.end(), [] (const LevelJob& a, const LevelJob& b)
+    {
+        return a.table->getLevelSize(a.level) > b.table->getLevelSize(b.level);
+    });
+
+    runJobs((int)jobs.size(), [&jobs] (int index)
+    {
+        const LevelJob& job = jobs[(size_t)index];
+        renderLevel(*job.table, job.level, job.frame, *job.spectrum);
+    }, pool);
+}
+
+void WavetableCreator::addLevels(MipmappedWavetable& table, int tableSize)
+{
+    int levelSize = tableSize;
+    int maxHarmonic = jmax(1, levelSize / samplesPerHarmonic);
+
+    while (true)
+    {
+        table.addLevel(levelSize, maxHarmonic);
+
+        if (maxHarmonic == 1)
+        {
+            break;
+        }
+
+        maxHarmonic /= 2;
+        levelSize = jmax(minimumLevelSize, levelSize / 2);
+    }
+}
+
+void WavetableCreator::renderLevel(MipmappedWavetable& table, int level, int frame, const HarmonicSpectrum& spectrum)
+{
+    int levelSize = table.getLevelSize(level);
+    int maxHarmonic = table.getLevelHarmonics(level);
+
+    dsp::FFT fft(getFFTOrder(levelSize));
+
+    // Real-only transforms work in place on twice the level size: levelSize / 2 + 1 interleaved complex bins in,
+    // levelSize samples out
+    std::vector<float> bins((size_t)levelSize * 2, 0.0f);
+
+    // The inverse transform is scaled by 1 / levelSize and each bin contributes twice its real part,
+    // so a bin of (levelSize / 2) * amplitude * e^(i * (phase - pi / 2)) gives amplitude * sin(hx + phase)
+    float binScale = (float)levelSize * 0.5f;
+
+    for (int harmonic = 1; harmonic <= maxHarmonic; ++harmonic)
+    {
+        float amplitude = spectrum.amplitude(harmonic);
+
+        if (amplitude == 0.0f)
+        {
+            continue;
+        }
+
+        float phase = spectrum.phase ? spectrum.phase(harmonic) : 0.0f;
+
+        bins[(size_t)harmonic * 2] = binScale * amplitude * std::sin(phase);
+        bins[(size_t)harmonic * 2 + 1] = -binScale * amplitude * std::cos(phase);
+    }
+
+    fft.performRealOnlyInverseTransform(bins.data());
+
+    FloatVectorOperations::copy(table.getLevelWritePointer(level, frame), bins.data(), levelSize);
+}
+
+void WavetableCreator::normaliseLevels(MipmappedWavetable& table)
+{
+    // Largest absolute sample of level 0 across every frame, used to normalise every level
+    float peak = 0.0f;
+
+    for (int frame = 0; frame < table.getNumFrames(); ++frame)
+    {
+        auto range = FloatVectorOperations::findMinAndMax(table.getLevelReadPointer(0, frame), table.getLevelSize(0));
+        peak = jmax(peak, std::abs(range.getStart()), std::abs(range.getEnd()));
+    }
+
+    float gain = (peak > 0.0f) ? 1.0f / peak : 1.0f;
+
+    for (int level = 0; level < table.getNumLevels(); ++level)
+    {
+        int size = table.getLevelSize(level);
+
+        for (int frame = 0; frame < table.getNumFrames(); ++frame)
+        {
+            FloatVectorOperations::multiply(table.getLevelWritePointer(level, frame), gain, size);
+            table.fillGuardSamples(level, frame);
+        }
+    }
+}
+
+int WavetableCreator::getFFTOrder(int size) noexcept
+{
+    int order = 0;
+    while ((1 << order) < size)
+    {
+        ++order;
+    }
+
+    return order;
+}
+
+void WavetableCreator::runJobs(int numJobs, const std::function<void(int)>& job, ThreadPool* pool)
+{
+    // Shared with the pool's threads, which may only get round to starting after every job is done and this has returned
+    struct JobState
+    {
+        std::atomic<int> nextJob { 0 };
+        std::atomic<int> finishedJobs { 0 };
+        WaitableEvent allFinished;
+    };
+
+    auto state = std::make_shared<JobState>();
+
+    // Late starters find nothing left to claim, so never touch job once this has returned
+    auto claimJobs = [state, &job, numJobs]
+    {
+        for (int i = state->nextJob++; i < numJobs; i = state->nextJob++)
+        {
+            job(i);
+
+            if (++state->finishedJobs == numJobs)
+            {
+                state->allFinished.signal();
+            }
+        }
+    };
+
+    if (pool != nullptr)
+    {
+        int numHelpers = jmin(pool->getNumThreads(), numJobs - 1);
+
+        for (int i = 0; i < numHelpers; ++i)
+        {
+            pool->addJob(claimJobs);
+        }
+    }
+
+    claimJobs();
+
+    while (state->finishedJobs.load() < numJobs)
+    {
+        state->allFinished.wait(100);
+    }
+}
@@ -10,41 +10,213 @@
 
 #pragma once
 #include <JuceHeader.h>
+#include "MipmappedWavetable.h"
 
 // Class for creating wavetables for base oscillator types
 class WavetableCreator
 {
 public:
+    /** The harmonic content of a band-limited waveform.
+
+        Each harmonic h (1 = fundamental) adds amplitude(h) * sin(h * x + phase(h)) to the cycle.
+        phase may be left empty for sine phase on every harmonic. Both may be called from several threads at once.
+    */
+    struct HarmonicSpectrum
+    {
+        std::function<float(int)> amplitude;
+        std::function<float(int)> phase;
+    };
+
     // =====================================
     // ====== BASE WAVETABLE CREATION ======
     // =====================================
-    /** Creates a sine wavetable stored in an AudioBuffer and returns a shared pointer to it.
-    
-        The pointer is returned via move, so it must be assigned to another shared_ptr.
+    /** Creates a sine wavetable mip chain and returns it.
+
+        tableSize is the size of the largest level, and must be a power of two.
+    */
+    static std::unique_ptr<MipmappedWavetable> createSineTable(const unsigned int tableSize);
+
+    /** Creates a band-limited saw (falling ramp) wavetable mip chain and returns it.
+
+        tableSize is the size of the largest level, and must be a power of two.
+    */
+    static std::unique_ptr<MipmappedWavetable> createSawTable(const unsigned int tableSize);
+
+    /** Creates a band-limited ramp (rising saw) wavetable mip chain and returns it.
+
+        tableSize is the size of the largest level, and must be a power of two.
+    */
+    static std::unique_ptr<MipmappedWavetable> createRampTable(const unsigned int tableSize);
+
+    /** Creates a band-limited triangle wavetable mip chain and returns it.
+
+        tableSize is the size of the largest level, and must be a power of two.
+    */
+    static std::unique_ptr<MipmappedWavetable> createTriangleTable(const unsigned int tableSize);
+
+    /** Creates a band-limited square wavetable mip chain and returns it.
+
+        tableSize is the size of the largest level, and must be a power of two.
+    */
+    static std::unique_ptr<MipmappedWavetable> createSquareTable(const unsigned int tableSize);
+
+    // The base shapes, in the order their tables are registered
+    enum class BaseShape
+    {
+        sine = 0,
+        saw,
+        ramp,
+        triangle,
+        square
+    };
+
+    static constexpr int numBaseShapes = 5;
+
+    /** Returns the amplitude of a harmonic of a base shape, all in sine phase. constexpr, so tables can be generated at compile time.
+
+    */
+    static constexpr float getBaseShapeAmplitude(BaseShape shape, int harmonic) noexcept
+    {
+        switch (shape)
+        {
+            case BaseShape::sine:
+                return harmonic == 1 ? 1.0f : 0.0f;
+
+            // Falls from 1 to -1 over the cycle: sum of sin(hx) / h
+            case BaseShape::saw:
+                return 1.0f / (float)harmonic;
+
+            // Rises from -1 to 1 over the cycle: inverted saw
+            case BaseShape::ramp:
+                return -1.0f / (float)harmonic;
+
+            // Odd harmonics only, alternating sign, falling off with the square of the harmonic
+            case BaseShape::triangle:
+                if (harmonic % 2 == 0)
+                {
+                    return 0.0f;
+                }
+
+                return (((harmonic / 2) % 2 == 0) ? 1.0f : -1.0f) / (float)(harmonic * harmonic);
+
+            // Odd harmonics only, falling off with the harmonic
+            case BaseShape::square:
+                return (harmonic % 2 == 0) ? 0.0f : 1.0f / (float)harmonic;
+
+            default:
+                return 0.0f;
+        }
+    }
+
+    static HarmonicSpectrum getBaseShapeSpectrum(BaseShape shape);
+    static HarmonicSpectrum getSineSpectrum();
+    static HarmonicSpectrum getSawSpectrum();
+    static HarmonicSpectrum getRampSpectrum();
+    static HarmonicSpectrum getTriangleSpectrum();
+    static HarmonicSpectrum getSquareSpectrum();
+
+    // ===========================================
+    // ====== BAND-LIMITED TABLE GENERATION ======
+    // ===========================================
+    /** Creates a mip chain from a harmonic spectrum.
+
+        Level 0 holds tableSize / samplesPerHarmonic harmonics. Each further level halves both the
+        harmonics and the table size (to no less than minimumLevelSize) until only the fundamental is left.
+        All levels are normalised by the same factor so the chain has a peak of 1 without level jumps.
+    */
+    static std::unique_ptr<MipmappedWavetable> createMipmappedTable(const unsigned int tableSize,
+                                                                    const HarmonicSpectrum& spectrum);
+
+    /** Creates a mip chain for each spectrum, sharing the levels of every table out across pool.
+
+        Each level is synthesised from its spectrum with a single inverse FFT. The calling thread renders
+        levels too, and the call returns once all are done. If pool is nullptr, everything is rendered
+        on the calling thread.
+    */
+    static std::vector<std::unique_ptr<MipmappedWavetable>> createMipmappedTables(const unsigned int tableSize,
+                                                                                  const std::vector<HarmonicSpectrum>& spectra,
+                                                                                  ThreadPool* pool);
+
+    /** Creates a multi-frame mip chain with one frame per spectrum, sharing the levels of every frame out across pool.
+
+        Every frame is normalised by the same factor, so frames keep their levels relative to each other.
+    */
+    static std::unique_ptr<MipmappedWavetable> createMultiFrameTable(const unsigned int tableSize,
+                                                                     const std::vector<HarmonicSpectrum>& frameSpectra,
+                                                                     ThreadPool* pool);
+
+    // ====================================
+    // ====== TABLES FROM RAW CYCLES ======
+    // ====================================
+    /** Creates a chain of numFrames zeroed frames, with every level a top level of tableSize needs.
+
+        Fill it with renderFramesFromCycles, then call normaliseLevels once every frame is done.
+    */
+    static std::unique_ptr<MipmappedWavetable> createEmptyTable(const unsigned int tableSize, int numFrames);
+
+    /** Band-limits numCycles single cycles into consecutive frames of table, starting at firstFrame.
+
+        cycles holds the cycles back to back, each as long as the top level of table. Each cycle is analysed with one
+        forward FFT, and its harmonics up to each level's highest are resynthesised straight into that level, so nothing
+        is held between calls. Cycles are shared out across pool; if pool is nullptr, they're all rendered on the calling thread.
+    */
+    static void renderFramesFromCycles(MipmappedWavetable& table, int firstFrame, const float* cycles, int numCycles, ThreadPool* pool);
+
+    /** Scales every frame of every level by the peak of level 0 across all frames, and fills each frame's guard samples.
+
+    */
+    static void normaliseLevels(MipmappedWavetable& table);
+
+    // =============================
+    // ====== COMPACT STORAGE ======
+    // =============================
+    /** Creates a copy of a float32 chain with its samples stored in format.
+
+        Each frame of each level is scaled to fill the format's range, and the scale kept alongside it.
     */
-    static std::shared_ptr<AudioBuffer<float>> createSineTable(const unsigned int tableSize);
+    static std::unique_ptr<MipmappedWavetable> createCompactTable(const MipmappedWavetable& source, WavetableSampleFormat format);
+
+    // Identifies the output of the generator and base spectra. Bump whenever either changes, so cached tables are regenerated
+    static constexpr uint32 generatorVersion = 1;
+
+    // Table samples per cycle of the highest harmonic in each level. Keeps linear interpolation accurate
+    static constexpr int samplesPerHarmonic = 4;
+
+    // Smallest table any level will use
+    static constexpr int minimumLevelSize = 64;
+
+private:
+    /** Adds every zeroed level of a chain with the given top level size to table.
+
+    */
+    static void addLevels(MipmappedWavetable& table, int tableSize);
+
+    // One frame of one level of a chain, for a single job to render
+    struct LevelJob
+    {
+        MipmappedWavetable* table;
+        int level;
+        int frame;
+        const HarmonicSpectrum* spectrum;
+    };
 
-    /** Creates a saw wavetable stored in an AudioBuffer and returns a shared pointer to it.
+    /** Renders every job, spread across pool and the calling thread, largest levels first.
 
-        The pointer is returned via move, so it must be assigned to another shared_ptr.
     */
-    static std::shared_ptr<AudioBuffer<float>> createSawTable(const unsigned int tableSize);
+    static void renderLevels(std::vector<LevelJob>& jobs, ThreadPool* pool);
 
-    /** Creates a ramp wavetable stored in an AudioBuffer and returns a shared pointer to it.
+    /** Fills one frame of one level of table with its harmonics of spectrum, using an inverse FFT the size of the level.
 
-        The pointer is returned via move, so it must be assigned to another shared_ptr.
     */
-    static std::shared_ptr<AudioBuffer<float>> createRampTable(const unsigned int tableSize);
+    static void renderLevel(MipmappedWavetable& table, int level, int frame, const HarmonicSpectrum& spectrum);
 
-    /** Creates a triangle wavetable stored in an AudioBuffer and returns a shared pointer to it.
+    /** Returns the log2 of a power of two size, as taken by dsp::FFT.
 
-        The pointer is returned via move, so it must be assigned to another shared_ptr.
     */
-    static std::shared_ptr<AudioBuffer<float>> createTriangleTable(const unsigned int tableSize);
+    static int getFFTOrder(int size) noexcept;
 
-    /** Creates a square wavetable stored in an AudioBuffer and returns a shared pointer to it.
+    /** Calls job for each index below numJobs, spread across pool and the calling thread. Returns once every job has finished.
 
-        The pointer is returned via move, so it must be assigned to another shared_ptr.
     */
-    static std::shared_ptr<AudioBuffer<float>> createSquareTable(const unsigned int tableSize);
-};
\ No newline at end of file
+    static void runJobs(int numJobs, const std::function<void(int)>& job, ThreadPool* pool);
+};
@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    WavetableImporter.cpp
+    Created: 17 Oct 2026 10:14:52pm
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#include "WavetableImporter.h"
+#include "WavetableCreator.h"
+
+std::unique_ptr<MipmappedWavetable> WavetableImporter::importFile(const File& file,
+                                                                  int samplesPerFrame,
+                                                                  String& error,
+                                                                  ThreadPool* pool,
+                                                                  const std::function<bool()>& shouldExit)
+{
+    if (!isPowerOfTwo(samplesPerFrame) || samplesPerFrame < WavetableCreator::minimumLevelSize)
+    {
+        error = "Frame size must be a power of two of at least " + String(WavetableCreator::minimumLevelSize) + " samples";
+        return nullptr;
+    }
+
+    AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+    if (reader == nullptr)
+    {
+        error = "Couldn't read " + file.getFileName();
+        return nullptr;
+    }
+
+    int64 numFrames64 = reader->lengthInSamples / samplesPerFrame;
+
+    if (numFrames64 < 1 || numFrames64 > (int64)std::numeric_limits<int>::max())
+    {
+        error = file.getFileName() + " doesn't hold a usable number of " + String(samplesPerFrame) + " sample frames";
+        return nullptr;
+    }
+
+    int numFrames = (int)numFrames64;
+
+    // Allocated once at its final size, so frames are written where oscillators will read them
+    std::unique_ptr<MipmappedWavetable> table = WavetableCreator::createEmptyTable((unsigned int)samplesPerFrame, numFrames);
+
+    // ==============================
+    // ====== STREAM IN CHUNKS ======
+    // ==============================
+    int numChannels = jmin(2, (int)reader->numChannels);
+    AudioBuffer<float> chunk(numChannels, framesPerChunk * samplesPerFrame);
+
+    for (int firstFrame = 0; firstFrame < numFrames; firstFrame += framesPerChunk)
+    {
+        if (shouldExit && shouldExit())
+        {
+            error = "Import cancelled";
+            return nullptr;
+        }
+
+        int numChunkFrames = jmin(framesPerChunk, numFrames - firstFrame);
+        int numChunkSamples = numChunkFrames * samplesPerFrame;
+
+        int64 chunkStart = (int64)firstFrame * samplesPerFrame;
+
+        // This read doesn't report failure, so never ask it for samples past the end of the file
+        if (chunkStart + numChunkSamples > reader->lengthInSamples)
+        {
+            error = "Couldn't read " + file.getFileName();
+            return nullptr;
+        }
+
+        reader->read(&chunk, 0, numChunkSamples, chunkStart, true, true);
+
+        float* cycles = chunk.getWritePointer(0);
+
+        // Mix stereo files down to mono
+        if (numChannels == 2)
+        {
+            FloatVectorOperations::add(cycles, chunk.getReadPointer(1), numChunkSamples);
+            FloatVectorOperations::multiply(cycles, 0.5f, numChunkSamples);
+        }
+
+        WavetableCreator::renderFramesFromCycles(*table, firstFrame, cycles, numChunkFrames, pool);
+    }
+
+    WavetableCreator::normaliseLevels(*table);
+
+    return table;
+}
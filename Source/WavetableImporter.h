@@ -0,0 +1,48 @@
+/*
+  ==============================================================================
+
+    WavetableImporter.h
+    Created: 17 Oct 2026 10:14:52pm
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MipmappedWavetable.h"
+
+
+/** Turns audio files of back-to-back single-cycle frames into multi-frame mip chains.
+
+    Files are read a chunk of frames at a time, and each chunk is band-limited straight into the chain's levels
+    before the next is read, so only the finished chain and one chunk are ever in memory however large the file.
+    The chain comes back in the same aligned layout as generated tables, ready for oscillators to read in place.
+
+    Importing takes as long as reading the whole file, so it's meant for a background thread, whose owner can
+    abandon it part way through with shouldExit.
+*/
+class WavetableImporter
+{
+public:
+    // Samples per frame in most wavetable files
+    static constexpr int defaultSamplesPerFrame = 2048;
+
+    // Frames read from the file at a time
+    static constexpr int framesPerChunk = 64;
+
+    //==============================================================================
+    /** Imports a file with samplesPerFrame samples in each frame, which must be a power of two, and returns the chain
+        or nullptr with error set.
+
+        Frames are normalised together so the loudest has a peak of 1, and any samples after the last whole frame are ignored.
+        Stereo files are mixed to mono. Each chunk is shared out across pool, if it isn't nullptr. shouldExit, if set, is
+        checked between chunks and abandons the import if it returns true.
+    */
+    static std::unique_ptr<MipmappedWavetable> importFile(const File& file,
+                                                          int samplesPerFrame,
+                                                          String& error,
+                                                          ThreadPool* pool = nullptr,
+                                                          const std::function<bool()>& shouldExit = {});
+};
@@ -0,0 +1,459 @@
+/*
+  ==============================================================================
+
+    WavetableInterpolation.h
+    Created: 18 Oct 2026 2:37:52am
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MipmappedWavetable.h"
+#include "WavetableSampleFormat.h"
+
+
+/** How oscillators read between the samples of a table, cheapest first. Compiled from IDs::interpolation.
+
+*/
+enum class InterpolationMode
+{
+    // The closest sample. Audibly rough, but costs one read
+    nearest = 0,
+
+    // A straight line between the two samples either side
+    linear,
+
+    // A 4-point, 3rd-order Hermite curve
+    hermite,
+
+    // An 8-point windowed sinc
+    sinc
+};
+
+static constexpr int numInterpolationModes = 4;
+
+//==================================================================================
+/** One frame of one table, read and decoded from format before its scale is applied.
+
+    The reader an oscillator's kernels use. Indices may reach into the frame's guard samples.
+*/
+template <WavetableSampleFormat format>
+struct FrameReader
+{
+    using Traits = WavetableSampleTraits<format>;
+
+    const typename Traits::Type* samples;
+
+    forcedinline float read(int32 index) const noexcept
+    {
+        return Traits::decode(samples[index]);
+    }
+
+   #if SYNTHFRAMEWORK_SSE2
+    /** Reads four positions, each offset samples after the one in indices.
+
+    */
+    forcedinline __m128 read4(const int32* indices, int32 offset) const noexcept
+    {
+        return Traits::load4(samples, samples, samples, samples,
+                             indices[0] + offset, indices[1] + offset, indices[2] + offset, indices[3] + offset);
+    }
+   #endif
+};
+
+#if SYNTHFRAMEWORK_SSE2
+/** One frame from each of four tables, for lanes that each read their own. Only reads four at a time.
+
+*/
+template <WavetableSampleFormat format>
+struct LaneFrameReader
+{
+    using Traits = WavetableSampleTraits<format>;
+
+    const typename Traits::Type* samples[4];
+
+    forcedinline __m128 read4(const int32* indices, int32 offset) const noexcept
+    {
+        return Traits::load4(samples[0], samples[1], samples[2], samples[3],
+                             indices[0] + offset, indices[1] + offset, indices[2] + offset, indices[3] + offset);
+    }
+};
+#endif
+
+#if SYNTHFRAMEWORK_AVX2
+/** One frame from each of eight tables, for the AVX2 lane renderer. Only reads eight at a time.
+
+*/
+template <WavetableSampleFormat format>
+struct LaneFrameReader8
+{
+    using Traits = WavetableSampleTraits<format>;
+
+    const typename Traits::Type* samples[8];
+
+    forcedinline __m256 read8(const int32* indices, int32 offset) const noexcept
+    {
+        return Traits::load8(samples, indices, offset);
+    }
+};
+#endif
+
+//==================================================================================
+/** The interpolation kernels, each a policy for the oscillators' templated render loops.
+
+    A kernel is made once per block. interpolate returns the value at index + frac from a reader, and interpolate4
+    does the same for four positions at once, or interpolate8 for eight with AVX2. tapsBefore and tapsAfter are how far either side of index a kernel
+    reads, which MipmappedWavetable's guard samples must cover.
+*/
+struct NearestInterpolation
+{
+    static constexpr int tapsBefore = 0;
+    static constexpr int tapsAfter = 1;
+
+    template <typename Reader>
+    forcedinline float interpolate(const Reader& reader, int32 index, float frac) const noexcept
+    {
+        return reader.read(index + (int32)(frac + 0.5f));
+    }
+
+   #if SYNTHFRAMEWORK_SSE2
+    template <typename Reader>
+    forcedinline __m128 interpolate4(const Reader& reader, __m128i index, __m128 frac) const noexcept
+    {
+        alignas(16) int32 indices[4];
+        _mm_store_si128((__m128i*)indices, _mm_add_epi32(index, _mm_cvttps_epi32(_mm_add_ps(frac, _mm_set1_ps(0.5f)))));
+
+        return reader.read4(indices, 0);
+    }
+   #endif
+
+   #if SYNTHFRAMEWORK_AVX2
+    template <typename Reader>
+    forcedinline __m256 interpolate8(const Reader& reader, __m256i index, __m256 frac) const noexcept
+    {
+        alignas(32) int32 indices[8];
+        _mm256_store_si256((__m256i*)indices, _mm256_add_epi32(index, _mm256_cvttps_epi32(_mm256_add_ps(frac, _mm256_set1_ps(0.5f)))));
+
+        return reader.read8(indices, 0);
+    }
+   #endif
+};
+
+struct LinearInterpolation
+{
+    static constexpr int tapsBefore = 0;
+    static constexpr int tapsAfter = 1;
+
+    template <typename Reader>
+    forcedinline float interpolate(const Reader& reader, int32 index, float frac) const noexcept
+    {
+        float value0 = reader.read(index);
+        float value1 = reader.read(index + 1);
+
+        return value0 + frac * (value1 - value0);
+    }
+
+   #if SYNTHFRAMEWORK_SSE2
+    template <typename Reader>
+    forcedinline __m128 interpolate4(const Reader& reader, __m128i index, __m128 frac) const noexcept
+    {
+        alignas(16) int32 indices[4];
+        _mm_store_si128((__m128i*)indices, index);
+
+        __m128 value0 = reader.read4(indices, 0);
+        __m128 value1 = reader.read4(indices, 1);
+
+        return _mm_add_ps(value0, _mm_mul_ps(frac, _mm_sub_ps(value1, value0)));
+    }
+   #endif
+
+   #if SYNTHFRAMEWORK_AVX2
+    template <typename Reader>
+    forcedinline __m256 interpolate8(const Reader& reader, __m256i index, __m256 frac) const noexcept
+    {
+        alignas(32) int32 indices[8];
+        _mm256_store_si256((__m256i*)indices, index);
+
+        __m256 value0 = reader.read8(indices, 0);
+        __m256 value1 = reader.read8(indices, 1);
+
+        return _mm256_add_ps(value0, _mm256_mul_ps(frac, _mm256_sub_ps(value1, value0)));
+    }
+   #endif
+};
+
+struct HermiteInterpolation
+{
+    static constexpr int tapsBefore = 1;
+    static constexpr int tapsAfter = 2;
+
+    template <typename Reader>
+    forcedinline float interpolate(const Reader& reader, int32 index, float frac) const noexcept
+    {
+        float previous = reader.read(index - 1);
+        float value0 = reader.read(index);
+        float value1 = reader.read(index + 1);
+        float value2 = reader.read(index + 2);
+
+        float c1 = 0.5f * (value1 - previous);
+        float c2 = previous - 2.5f * value0 + 2.0f * value1 - 0.5f * value2;
+        float c3 = 0.5f * (value2 - previous) + 1.5f * (value0 - value1);
+
+        return ((c3 * frac + c2) * frac + c1) * frac + value0;
+    }
+
+   #if SYNTHFRAMEWORK_SSE2
+    template <typename Reader>
+    forcedinline __m128 interpolate4(const Reader& reader, __m128i index, __m128 frac) const noexcept
+    {
+        alignas(16) int32 indices[4];
+        _mm_store_si128((__m128i*)indices, index);
+
+        __m128 previous = reader.read4(indices, -1);
+        __m128 value0 = reader.read4(indices, 0);
+        __m128 value1 = reader.read4(indices, 1);
+        __m128 value2 = reader.read4(indices, 2);
+
+        __m128 half = _mm_set1_ps(0.5f);
+
+        __m128 c1 = _mm_mul_ps(half, _mm_sub_ps(value1, previous));
+        __m128 c2 = _mm_sub_ps(_mm_add_ps(previous, _mm_add_ps(value1, value1)),
+                               _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.5f), value0), _mm_mul_ps(half, value2)));
+        __m128 c3 = _mm_add_ps(_mm_mul_ps(half, _mm_sub_ps(value2, previous)),
+                               _mm_mul_ps(_mm_set1_ps(1.5f), _mm_sub_ps(value0, value1)));
+
+        __m128 result = _mm_add_ps(_mm_mul_ps(c3, frac), c2);
+        result = _mm_add_ps(_mm_mul_ps(result, frac), c1);
+
+        return _mm_add_ps(_mm_mul_ps(result, frac), value0);
+    }
+   #endif
+
+   #if SYNTHFRAMEWORK_AVX2
+    template <typename Reader>
+    forcedinline __m256 interpolate8(const Reader& reader, __m256i index, __m256 frac) const noexcept
+    {
+        alignas(32) int32 indices[8];
+        _mm256_store_si256((__m256i*)indices, index);
+
+        __m256 previous = reader.read8(indices, -1);
+        __m256 value0 = reader.read8(indices, 0);
+        __m256 value1 = reader.read8(indices, 1);
+        __m256 value2 = reader.read8(indices, 2);
+
+        __m256 half = _mm256_set1_ps(0.5f);
+
+        __m256 c1 = _mm256_mul_ps(half, _mm256_sub_ps(value1, previous));
+        __m256 c2 = _mm256_sub_ps(_mm256_add_ps(previous, _mm256_add_ps(value1, value1)),
+                                  _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(2.5f), value0), _mm256_mul_ps(half, value2)));
+        __m256 c3 = _mm256_add_ps(_mm256_mul_ps(half, _mm256_sub_ps(value2, previous)),
+                                  _mm256_mul_ps(_mm256_set1_ps(1.5f), _mm256_sub_ps(value0, value1)));
+
+        __m256 result = _mm256_add_ps(_mm256_mul_ps(c3, frac), c2);
+        result = _mm256_add_ps(_mm256_mul_ps(result, frac), c1);
+
+        return _mm256_add_ps(_mm256_mul_ps(result, frac), value0);
+    }
+   #endif
+};
+
+/** A Blackman-windowed sinc, 8 taps wide, with coefficients read from a table of fractional positions.
+
+    Tables are band-limited to a quarter of their own sample rate, well inside the kernel's passband, so the
+    short kernel is enough. Coefficients are interpolated between the table's rows, so the fraction isn't quantised.
+*/
+struct SincInterpolation
+{
+    static constexpr int numTaps = 8;
+    static constexpr int tapsBefore = numTaps / 2 - 1;
+    static constexpr int tapsAfter = numTaps / 2;
+
+    // Rows of coefficients, from a fraction of 0 up to 1
+    static constexpr int numPhases = 256;
+
+    struct Coefficients
+    {
+        // Each row's taps, then how much each changes by the next row
+        alignas(16) float taps[numPhases][numTaps];
+        alignas(16) float deltas[numPhases][numTaps];
+    };
+
+    /** Returns the coefficients, building them the first time. Call once before rendering, off the audio thread.
+
+    */
+    static const Coefficients& getCoefficients()
+    {
+        static const Coefficients coefficients = createCoefficients();
+        return coefficients;
+    }
+
+    // Looked up as the kernel is made, so the table is only found once per block
+    const Coefficients& coefficients = getCoefficients();
+
+    template <typename Reader>
+    forcedinline float interpolate(const Reader& reader, int32 index, float frac) const noexcept
+    {
+        float position = frac * (float)numPhases;
+        int row = jmin((int)position, numPhases - 1);
+        float rowFrac = position - (float)row;
+
+        float sum = 0.0f;
+
+        for (int tap = 0; tap < numTaps; ++tap)
+        {
+            float coefficient = coefficients.taps[row][tap] + rowFrac * coefficients.deltas[row][tap];
+            sum += coefficient * reader.read(index + tap - tapsBefore);
+        }
+
+        return sum;
+    }
+
+   #if SYNTHFRAMEWORK_SSE2
+    template <typename Reader>
+    forcedinline __m128 interpolate4(const Reader& reader, __m128i index, __m128 frac) const noexcept
+    {
+        alignas(16) int32 indices[4];
+        _mm_store_si128((__m128i*)indices, index);
+
+        __m128 position = _mm_mul_ps(frac, _mm_set1_ps((float)numPhases));
+        __m128i rowIndex = _mm_cvttps_epi32(position);
+        __m128 rowFrac = _mm_sub_ps(position, _mm_cvtepi32_ps(rowIndex));
+
+        alignas(16) int32 rows[4];
+        alignas(16) float rowFracs[4];
+        _mm_store_si128((__m128i*)rows, rowIndex);
+        _mm_store_ps(rowFracs, rowFrac);
+
+        // Each position's 8 coefficients, as two vectors of 4 taps
+        __m128 low[4];
+        __m128 high[4];
+
+        for (int i = 0; i < 4; ++i)
+        {
+            int row = jmin(rows[i], numPhases - 1);
+            __m128 t = _mm_set1_ps(rowFracs[i]);
+
+            low[i] = _mm_add_ps(_mm_load_ps(coefficients.taps[row]), _mm_mul_ps(t, _mm_load_ps(coefficients.deltas[row])));
+            high[i] = _mm_add_ps(_mm_load_ps(coefficients.taps[row] + 4), _mm_mul_ps(t, _mm_load_ps(coefficients.deltas[row] + 4)));
+        }
+
+        // Now each vector holds one tap of all four positions, matching the reads
+        _MM_TRANSPOSE4_PS(low[0], low[1], low[2], low[3]);
+        _MM_TRANSPOSE4_PS(high[0], high[1], high[2], high[3]);
+
+        __m128 sum = _mm_mul_ps(low[0], reader.read4(indices, -tapsBefore));
+        sum = _mm_add_ps(sum, _mm_mul_ps(low[1], reader.read4(indices, 1 - tapsBefore)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(low[2], reader.read4(indices, 2 - tapsBefore)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(low[3], reader.read4(indices, 3 - tapsBefore)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(high[0], reader.read4(indices, 4 - tapsBefore)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(high[1], reader.read4(indices, 5 - tapsBefore)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(high[2], reader.read4(indices, 6 - tapsBefore)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(high[3], reader.read4(indices, 7 - tapsBefore)));
+
+        return sum;
+    }
+   #endif
+
+   #if SYNTHFRAMEWORK_AVX2
+    template <typename Reader>
+    forcedinline __m256 interpolate8(const Reader& reader, __m256i index, __m256 frac) const noexcept
+    {
+        alignas(32) int32 indices[8];
+        _mm256_store_si256((__m256i*)indices, index);
+
+        __m256 position = _mm256_mul_ps(frac, _mm256_set1_ps((float)numPhases));
+        __m256i rowIndex = _mm256_cvttps_epi32(position);
+        __m256 rowFrac = _mm256_sub_ps(position, _mm256_cvtepi32_ps(rowIndex));
+
+        // Where each position's row starts, in floats. The coefficient table is shared, so each tap
+        // is one gather from it rather than eight rows loaded and transposed
+        __m256i rowStarts = _mm256_slli_epi32(_mm256_min_epi32(rowIndex, _mm256_set1_epi32(numPhases - 1)), 3);
+        static_assert(numTaps == 8, "rowStarts assumes 8 taps per row");
+
+        __m256 sum = _mm256_setzero_ps();
+
+        for (int tap = 0; tap < numTaps; ++tap)
+        {
+            __m256 coefficient = _mm256_add_ps(_mm256_i32gather_ps(&coefficients.taps[0][tap], rowStarts, 4),
+                                               _mm256_mul_ps(rowFrac, _mm256_i32gather_ps(&coefficients.deltas[0][tap], rowStarts, 4)));
+
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(coefficient, reader.read8(indices, tap - tapsBefore)));
+        }
+
+        return sum;
+    }
+   #endif
+
+private:
+    static Coefficients createCoefficients()
+    {
+        Coefficients result;
+
+        // One extra row, at a fraction of 1, for the last row's deltas
+        double rows[numPhases + 1][numTaps];
+
+        for (int phase = 0; phase <= numPhases; ++phase)
+        {
+            double frac = (double)phase / (double)numPhases;
+            double sum = 0.0;
+
+            for (int tap = 0; tap < numTaps; ++tap)
+            {
+                // Distance from the position being read to this tap
+                double x = (double)(tap - tapsBefore) - frac;
+                double sinc = x == 0.0 ? 1.0 : std::sin(MathConstants<double>::pi * x) / (MathConstants<double>::pi * x);
+
+                // Blackman window spanning the kernel, centred on the position
+                double w = (x + (double)numTaps * 0.5) / (double)numTaps;
+                double window = 0.42 - 0.5 * std::cos(MathConstants<double>::twoPi * w) + 0.08 * std::cos(2.0 * MathConstants<double>::twoPi * w);
+
+                rows[phase][tap] = sinc * window;
+                sum += rows[phase][tap];
+            }
+
+            // Unity gain at DC, so a held value reads back unchanged
+            for (int tap = 0; tap < numTaps; ++tap)
+            {
+                rows[phase][tap] /= sum;
+            }
+        }
+
+        for (int phase = 0; phase < numPhases; ++phase)
+        {
+            for (int tap = 0; tap < numTaps; ++tap)
+            {
+                result.taps[phase][tap] = (float)rows[phase][tap];
+                result.deltas[phase][tap] = (float)(rows[phase + 1][tap] - rows[phase][tap]);
+            }
+        }
+
+        return result;
+    }
+};
+
+static_assert(SincInterpolation::tapsBefore <= MipmappedWavetable::guardSamplesBefore
+              && SincInterpolation::tapsAfter <= MipmappedWavetable::guardSamplesAfter
+              && HermiteInterpolation::tapsBefore <= MipmappedWavetable::guardSamplesBefore
+              && HermiteInterpolation::tapsAfter <= MipmappedWavetable::guardSamplesAfter,
+              "Every kernel must only read samples inside a frame's guard samples");
+
+//==================================================================================
+/** Calls render with a kernel for mode, whose type picks the template instantiation.
+
+    The one place a mode is turned into a kernel, once per block, so the loops inside never branch on it.
+*/
+template <typename Function>
+forcedinline void withInterpolationKernel(InterpolationMode mode, Function&& render)
+{
+    switch (mode)
+    {
+        case InterpolationMode::nearest:    render(NearestInterpolation()); break;
+        case InterpolationMode::hermite:    render(HermiteInterpolation()); break;
+        case InterpolationMode::sinc:       render(SincInterpolation()); break;
+        case InterpolationMode::linear:
+        default:                            render(LinearInterpolation()); break;
+    }
+}
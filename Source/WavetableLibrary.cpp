@@ -0,0 +1,388 @@
+/*
+  ==============================================================================
+
+    WavetableLibrary.cpp
+    Created: 17 Oct 2026 11:37:26pm
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#include "WavetableLibrary.h"
+#include "WavetableCache.h"
+#include "WavetableCreator.h"
+#include "WavetableImporter.h"
+
+WavetableLibrary::WavetableLibrary()
+    : Thread("Wavetable library")
+{
+    startThread();
+}
+
+WavetableLibrary::~WavetableLibrary()
+{
+    // Abandons any prefetch in progress at its next chunk
+    stopThread(4000);
+}
+
+//==============================================================================
+void WavetableLibrary::addDirectory(const File& directory)
+{
+    // Sorted, so tables are numbered in path order
+    std::vector<File> files;
+
+    for (const File& file : directory.findChildFiles(File::findFiles, true, "*.wav;*.aif;*.aiff;*.flac"))
+    {
+        files.push_back(file);
+    }
+
+    std::sort(files.begin(), files.end(), [] (const File& a, const File& b)
+    {
+        return a.getFullPathName() < b.getFullPathName();
+    });
+
+    const ScopedLock sl(lock);
+
+    for (const File& file : files)
+    {
+        if (indexedFiles.count(file.getFullPathName()) != 0)
+        {
+            continue;
+        }
+
+        Entry entry;
+        entry.name = file.getFileNameWithoutExtension();
+        entry.file = file;
+
+        // The first table with a name keeps it
+        idsByName.emplace(entry.name, (int)entries.size());
+        indexedFiles.insert(file.getFullPathName());
+
+        entries.push_back(std::move(entry));
+    }
+}
+
+int WavetableLibrary::addFile(const File& file)
+{
+    const ScopedLock sl(lock);
+
+    auto found = std::find_if(entries.begin(), entries.end(), [&file] (const Entry& entry) { return entry.file == file; });
+
+    if (found == entries.end())
+    {
+        Entry entry;
+        entry.name = file.getFileNameWithoutExtension();
+        entry.file = file;
+
+        indexedFiles.insert(file.getFullPathName());
+        entries.push_back(std::move(entry));
+
+        found = entries.end() - 1;
+    }
+    else
+    {
+        if (found->table != nullptr)
+        {
+            found->table = nullptr;
+            residentBytes -= found->numBytes;
+            found->numBytes = 0;
+
+            lru.erase(found->lruPosition);
+        }
+
+        found->failed = false;
+        found->error = String();
+    }
+
+    int tableId = (int)(found - entries.begin());
+    idsByName[found->name] = tableId;
+
+    return tableId;
+}
+
+int WavetableLibrary::getNumTables() const
+{
+    const ScopedLock sl(lock);
+    return (int)entries.size();
+}
+
+int WavetableLibrary::getTableId(const String& name) const
+{
+    const ScopedLock sl(lock);
+
+    auto found = idsByName.find(name);
+    return found != idsByName.end() ? found->second : -1;
+}
+
+String WavetableLibrary::getTableName(int tableId) const
+{
+    const ScopedLock sl(lock);
+
+    jassert(isPositiveAndBelow(tableId, (int)entries.size()));
+    return isPositiveAndBelow(tableId, (int)entries.size()) ? entries[(size_t)tableId].name : String();
+}
+
+//==============================================================================
+WavetableHandle WavetableLibrary::getIfResident(int tableId)
+{
+    const ScopedLock sl(lock);
+
+    if (!isPositiveAndBelow(tableId, (int)entries.size()) || entries[(size_t)tableId].table == nullptr)
+    {
+        return nullptr;
+    }
+
+    markUsed(tableId);
+    return entries[(size_t)tableId].table;
+}
+
+WavetableHandle WavetableLibrary::load(int tableId)
+{
+    if (WavetableHandle table = getIfResident(tableId))
+    {
+        return table;
+    }
+
+    const ScopedLock loadSl(loadLock);
+
+    File file;
+    WavetableSampleFormat format;
+
+    {
+        const ScopedLock sl(lock);
+
+        jassert(isPositiveAndBelow(tableId, (int)entries.size()));
+        if (!isPositiveAndBelow(tableId, (int)entries.size()))
+        {
+            return nullptr;
+        }
+
+        Entry& entry = entries[(size_t)tableId];
+
+        // Another thread may have loaded it while this one waited for loadLock
+        if (entry.table != nullptr)
+        {
+            markUsed(tableId);
+            return entry.table;
+        }
+
+        if (entry.failed)
+        {
+            return nullptr;
+        }
+
+        file = entry.file;
+        format = sampleFormat;
+    }
+
+    // Read without holding lock, so lookups of other tables aren't held up
+    String error;
+    std::unique_ptr<MipmappedWavetable> loaded = readTable(file, error);
+
+    // Converted from the cached floats, which are then unmapped
+    if (loaded != nullptr && format != WavetableSampleFormat::float32)
+    {
+        loaded = WavetableCreator::createCompactTable(*loaded, format);
+    }
+
+    const ScopedLock sl(lock);
+    Entry& entry = entries[(size_t)tableId];
+
+    if (loaded == nullptr)
+    {
+        // Abandoned because the library is going away, which says nothing about the file
+        if (threadShouldExit())
+        {
+            return nullptr;
+        }
+
+        // Not retried, so a broken file isn't converted again every time it's asked for
+        entry.failed = true;
+        entry.error = error;
+        return nullptr;
+    }
+
+    entry.numBytes = loaded->getSizeInBytes();
+    entry.table = collector->adopt(std::move(loaded));
+
+    lru.push_front(tableId);
+    entry.lruPosition = lru.begin();
+    residentBytes += entry.numBytes;
+
+    evictOverBudget(tableId);
+
+    return entry.table;
+}
+
+void WavetableLibrary::prefetch(int tableId)
+{
+    {
+        const ScopedLock sl(lock);
+
+        if (!isPositiveAndBelow(tableId, (int)entries.size())
+            || entries[(size_t)tableId].table != nullptr
+            || entries[(size_t)tableId].failed)
+        {
+            return;
+        }
+
+        if (std::find(prefetchQueue.begin(), prefetchQueue.end(), tableId) == prefetchQueue.end())
+        {
+            prefetchQueue.push_back(tableId);
+        }
+    }
+
+    notify();
+}
+
+//==============================================================================
+void WavetableLibrary::setMemoryBudget(size_t newBudget)
+{
+    const ScopedLock sl(lock);
+
+    memoryBudget = newBudget;
+    evictOverBudget(-1);
+}
+
+size_t WavetableLibrary::getResidentBytes() const
+{
+    const ScopedLock sl(lock);
+    return residentBytes;
+}
+
+void WavetableLibrary::setSampleFormat(WavetableSampleFormat newFormat)
+{
+    const ScopedLock sl(lock);
+    sampleFormat = newFormat;
+}
+
+//==============================================================================
+void WavetableLibrary::markUsed(int tableId)
+{
+    lru.splice(lru.begin(), lru, entries[(size_t)tableId].lruPosition);
+}
+
+void WavetableLibrary::evictOverBudget(int keepId)
+{
+    auto position = lru.end();
+
+    while (residentBytes > memoryBudget && position != lru.begin())
+    {
+        --position;
+
+        Entry& entry = entries[(size_t)*position];
+
+        // A table something outside the library holds a handle to is still being played. Dropping it wouldn't
+        // free it, only make the next lookup load it again
+        if (*position == keepId || entry.table.use_count() > 1)
+        {
+            continue;
+        }
+
+        entry.table = nullptr;
+        residentBytes -= entry.numBytes;
+        entry.numBytes = 0;
+
+        position = lru.erase(position);
+    }
+}
+
+std::unique_ptr<MipmappedWavetable> WavetableLibrary::readTable(const File& file, String& error)
+{
+    // Named after the file's path, and versioned by its size, modification time and the generator,
+    // so an edited file or a new generator is converted again rather than mapped stale
+    String setName = "Library-" + file.getFileNameWithoutExtension() + "-" + String::toHexString(file.getFullPathName().hashCode64());
+    File cacheFile = WavetableCache::getCacheFile(setName, (unsigned int)WavetableImporter::defaultSamplesPerFrame);
+
+    uint64 fingerprint = (uint64)file.getSize();
+    fingerprint = fingerprint * 31 + (uint64)file.getLastModificationTime().toMilliseconds();
+    fingerprint = fingerprint * 31 + WavetableCreator::generatorVersion;
+    uint32 contentVersion = (uint32)(fingerprint ^ (fingerprint >> 32));
+
+    std::vector<std::unique_ptr<MipmappedWavetable>> cached = WavetableCache::load(cacheFile,
+                                                                                   (unsigned int)WavetableImporter::defaultSamplesPerFrame,
+                                                                                   1, contentVersion);
+
+    if (!cached.empty())
+    {
+        return std::move(cached.front());
+    }
+
+    std::unique_ptr<MipmappedWavetable> table = WavetableImporter::importFile(file, WavetableImporter::defaultSamplesPerFrame, error, nullptr,
+                                                                             [this] { return threadShouldExit(); });
+
+    if (table == nullptr)
+    {
+        return nullptr;
+    }
+
+    std::vector<std::unique_ptr<MipmappedWavetable>> toCache;
+    toCache.push_back(std::move(table));
+
+    // Failing to cache only costs converting again next time
+    WavetableCache::save(cacheFile, toCache, contentVersion);
+
+    return std::move(toCache.front());
+}
+
+//==============================================================================
+void WavetableLibrary::run()
+{
+    while (!threadShouldExit())
+    {
+        int tableId = -1;
+
+        {
+            const ScopedLock sl(lock);
+
+            if (!prefetchQueue.empty())
+            {
+                tableId = prefetchQueue.front();
+                prefetchQueue.pop_front();
+            }
+        }
+
+        if (tableId < 0)
+        {
+            wait(-1);
+            continue;
+        }
+
+        bool loaded = load(tableId) != nullptr;
+
+        if (threadShouldExit())
+        {
+            continue;
+        }
+
+        WeakReference<WavetableLibrary> library(this);
+
+        if (loaded)
+        {
+            MessageManager::callAsync([library, tableId]
+            {
+                if (library != nullptr && library.get()->onTableLoaded)
+                {
+                    library.get()->onTableLoaded(tableId);
+                }
+            });
+
+            continue;
+        }
+
+        String error;
+
+        {
+            const ScopedLock sl(lock);
+            error = entries[(size_t)tableId].error;
+        }
+
+        MessageManager::callAsync([library, tableId, error]
+        {
+            if (library != nullptr && library.get()->onTableFailed)
+            {
+                library.get()->onTableFailed(tableId, error);
+            }
+        });
+    }
+}
@@ -0,0 +1,182 @@
+/*
+  ==============================================================================
+
+    WavetableLibrary.h
+    Created: 17 Oct 2026 11:37:26pm
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MipmappedWavetable.h"
+#include "WavetableCollector.h"
+
+
+/** An index of wavetable files on disk, loading each one only when it's first used and keeping a bounded number resident.
+
+    Indexing a directory only lists its files, so a library can hold thousands of tables at no cost until they're played.
+    Each table gets an id, its position in the index, which never changes for the life of the library. Ids aren't kept
+    from one run to the next, as adding a file to a directory moves the ones after it, so anything saved should refer to
+    tables by name.
+
+    Loaded tables are kept in a least recently used cache. Once the tables it holds add up to more than the memory budget,
+    the ones used longest ago are dropped. Tables that anything outside the library still holds a handle to, such as a
+    published OscillatorSet, are never dropped, so the tables being played stay resident however long ago they were
+    looked up. They still count towards the budget.
+
+    Tables are converted from their source file once and then cached with WavetableCache, so later loads, in this
+    or any other instance, map the converted chain straight in.
+*/
+class WavetableLibrary : private Thread
+{
+public:
+    // Resident bytes allowed before the least recently used tables are dropped
+    static constexpr size_t defaultMemoryBudget = 256 * 1024 * 1024;
+
+    WavetableLibrary();
+    ~WavetableLibrary();
+
+    // =======================
+    // ====== THE INDEX ======
+    // =======================
+    /** Adds every audio file under directory to the index, without opening any of them. Files already indexed are skipped.
+
+    */
+    void addDirectory(const File& directory);
+
+    /** Adds a single file to the index, and returns its id. Its name now refers to it, even if another table had the name first.
+
+        If the file is already indexed, the copy that's resident, if any, is dropped and a failed read is forgotten, so it's
+        read again on its next use and picks up any changes. Oscillators still playing the old copy keep it until they let go.
+    */
+    int addFile(const File& file);
+
+    /** Returns the number of tables in the index.
+
+    */
+    int getNumTables() const;
+
+    /** Returns the id of the first table named name, or -1 if there isn't one. Names are file names without their extension.
+
+    */
+    int getTableId(const String& name) const;
+
+    /** Returns the name of the table with id.
+
+    */
+    String getTableName(int tableId) const;
+
+    // ============================
+    // ====== LOADING TABLES ======
+    // ============================
+    /** Returns the table with id if it's resident, or nullptr if it isn't. Counts as a use of it.
+
+    */
+    WavetableHandle getIfResident(int tableId);
+
+    /** Returns the table with id, loading it on the calling thread if it isn't resident. Returns nullptr if it can't be loaded.
+
+        Can take as long as converting the file, so not for the message thread: see prefetch.
+    */
+    WavetableHandle load(int tableId);
+
+    /** Queues a table to be loaded in the background, if it isn't already resident, so it's ready by the time it's needed.
+
+        onTableLoaded is called on the message thread once it is.
+    */
+    void prefetch(int tableId);
+
+    // Called on the message thread with the id of each table a prefetch has made resident
+    std::function<void(int tableId)> onTableLoaded;
+
+    // Called on the message thread with the id of each table a prefetch couldn't load, and why
+    std::function<void(int tableId, const String& error)> onTableFailed;
+
+    // ==============================
+    // ====== MEMORY BUDGETING ======
+    // ==============================
+    /** Sets how many bytes of tables may be resident, dropping the least recently used ones if they're over it.
+
+        The table loaded last is always kept, even if it's larger than the whole budget.
+    */
+    void setMemoryBudget(size_t newBudget);
+
+    /** Returns the number of bytes taken by resident tables.
+
+    */
+    size_t getResidentBytes() const;
+
+    /** Sets the format tables loaded from now on are stored in. A compact format fits twice as many tables in the same budget.
+
+        Tables already resident keep their format.
+    */
+    void setSampleFormat(WavetableSampleFormat newFormat);
+
+private:
+    //==============================================================================
+    struct Entry
+    {
+        String name;
+        File file;
+
+        // Null if not resident
+        WavetableHandle table;
+        size_t numBytes = 0;
+
+        // Set if the file couldn't be read, so it isn't tried again, along with why
+        bool failed = false;
+        String error;
+
+        // Position in lru, if resident
+        std::list<int>::iterator lruPosition;
+    };
+
+    // Declared first, so it outlives every handle below
+    SharedResourcePointer<WavetableCollector> collector;
+
+    // Only ever added to, so ids stay valid. Guarded by lock
+    std::vector<Entry> entries;
+    std::map<String, int> idsByName;
+    std::set<String> indexedFiles;
+
+    // Ids of resident tables, most recently used first. Guarded by lock
+    std::list<int> lru;
+    size_t residentBytes = 0;
+    size_t memoryBudget = defaultMemoryBudget;
+    WavetableSampleFormat sampleFormat = WavetableSampleFormat::float32;
+
+    // Ids queued by prefetch. Guarded by lock
+    std::deque<int> prefetchQueue;
+
+    CriticalSection lock;
+
+    // Held while loading, so a table is only ever converted once however many threads ask for it
+    CriticalSection loadLock;
+
+    /** Moves a resident table to the front of lru. Call with lock held.
+
+    */
+    void markUsed(int tableId);
+
+    /** Drops the least recently used tables, other than keepId and any still in use, until the resident ones fit the budget.
+
+        Call with lock held.
+    */
+    void evictOverBudget(int keepId);
+
+    /** Maps a table's converted chain from the cache, or converts its source file and caches it. Returns nullptr with error set
+        if it can't be read.
+
+        Abandons converting if the library is being destroyed.
+    */
+    std::unique_ptr<MipmappedWavetable> readTable(const File& file, String& error);
+
+    void run() override;
+
+    //==============================================================================
+    JUCE_DECLARE_WEAK_REFERENCEABLE(WavetableLibrary)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WavetableLibrary)
+};
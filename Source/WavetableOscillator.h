@@ -12,72 +12,49 @@
 
 #include <JuceHeader.h>
 #include "Common.h"
+#include "MipmappedWavetable.h"
+#include "PhaseAccumulator.h"
+#include "PitchTable.h"
+#include "WavetableInterpolation.h"
 
 
 /** A class containing a wavetable reference and methods to parse through it.
 
-
+    Parameters arrive through setDetune and the manager's enabled checks rather than from
+    the value tree, so nothing here touches a ValueTree while rendering.
 */
-class WavetableOscillator : public ValueTree::Listener
+class WavetableOscillator
 {
 public:
-    /** Creates a new WavetableOscillator given an oscillatorParameters tree and a pointer to the wavetable.
+    /** Creates an empty oscillator with no wavetable, which can't play until one is assigned.
 
+        Oscillators are stored by value in an OscillatorBank, so they must be default constructible and copyable.
     */
-    WavetableOscillator(ValueTree params, std::shared_ptr<AudioBuffer<float>> wavetableToUse)
-        : oscParams (params)
-    {
-        oscWavetable = wavetableToUse;
-        tableSize = oscWavetable->getNumSamples() - 1;
-
-        // Initialise the cached detune parameter values
-        initDetune();
+    WavetableOscillator() = default;
 
-        // Ensure mono wavetable
-        jassert(oscWavetable->getNumChannels() == 1);
-
-        oscParams.addListener(this);
-    }
-
-    ~WavetableOscillator()
-    {
-        oscWavetable.reset();
-        oscParams.removeListener(this);
-    }
-
-    //==============================================================================
-    /** Returns a unique pointer to a clone of the oscillator.
+    /** Creates a new WavetableOscillator given a pointer to the wavetable.
 
+        The oscillator doesn't own the table. Whoever assigns it must keep a WavetableHandle to it
+        for as long as the oscillator can be rendered.
     */
-    std::unique_ptr<WavetableOscillator> clone()
+    WavetableOscillator(const MipmappedWavetable* wavetableToUse)
     {
-        std::unique_ptr<WavetableOscillator> oscClone = std::make_unique<WavetableOscillator>(oscParams, oscWavetable);
+        oscWavetable = wavetableToUse;
 
-        // Copy internal parameters
-        oscClone->currentSampleRate = currentSampleRate;
-        oscClone->currentNote = currentNote;
-        oscClone->currentFrequency = currentFrequency;
-        oscClone->currentIndex = currentIndex;
+        // Ensure the chain has at least one level
+        jassert(oscWavetable->getNumLevels() > 0);
 
-        return std::move(oscClone);
+        updateTableDelta();
     }
 
     //==============================================================================
     /** Returns true if there is a tableDelta set, as otherwise the oscillator can't play.
 
-        There will only be a tableDelta when both sample rate & frequency are set.
+        There will only be a tableDelta when both a pitch table & note are set.
     */
-    bool hasDelta()
+    bool hasDelta() const noexcept
     {
-        return tableDelta != 0.0f;
-    }
-
-    /** Returns true if the oscillator is enabled
-
-    */
-    bool isEnabled()
-    {
-        return oscParams.getProperty(IDs::enabled);
+        return phase.hasIncrement();
     }
 
     // ##############################
@@ -94,39 +71,108 @@ public:
     // =======================
     /** Set a new wavetable for the oscillator to walk through.
 
+        Keeps the oscillator's position in the cycle if the new table's levels are a different size.
     */
-    void setWavetable(std::shared_ptr<AudioBuffer<float>> newWavetable)
+    void setWavetable(const MipmappedWavetable* newWavetable)
     {
         oscWavetable = newWavetable;
 
-        // Store old table size for comparison
-        int oldSize = tableSize;
-        // Get new size
-        tableSize = oscWavetable->getNumSamples() - 1;
+        jassert(oscWavetable->getNumLevels() > 0);
+
+        updateTableDelta();
+    }
+
+    // ============================
+    // ====== FRAME POSITION ======
+    // ============================
+    /** Sets the position to scan to in a multi-frame wavetable, from 0 (first frame) to 1 (last frame).
+
+        The position glides there over the next few blocks, see advanceFramePosition.
+    */
+    void setFramePosition(float newPosition) noexcept
+    {
+        targetFramePosition = jlimit(0.0f, 1.0f, newPosition);
+    }
+
+    /** Returns the smoothed position being read, from 0 (first frame) to 1 (last frame).
+
+    */
+    float getFramePosition() const noexcept
+    {
+        return framePosition;
+    }
+
+    /** Moves the position towards the one last set, by as much as a block of numSamples allows. Call once per block, before rendering it.
 
-        // If size change
-        if (tableSize != oldSize)
+        The position is held for the whole block, so frame pointers and the mix between them are only worked out here.
+    */
+    void advanceFramePosition(int numSamples) noexcept
+    {
+        if (framePosition == targetFramePosition || currentSampleRate <= 0.0)
         {
-            // Update position in wavetable
-            float ratio = (float)tableSize / (float)oldSize;
-            currentIndex *= ratio;
+            return;
+        }
 
-            // Update delta for new size
-            updateTableDelta();
+        // One-pole glide, stepped once per block
+        float coefficient = 1.0f - (float)std::exp(-(double)numSamples / (framePositionSmoothingSeconds * currentSampleRate));
+        framePosition += coefficient * (targetFramePosition - framePosition);
+
+        if (std::abs(targetFramePosition - framePosition) < 1.0e-4f)
+        {
+            framePosition = targetFramePosition;
         }
+
+        updateFramePointers();
+    }
+
+    /** Returns the mip chain being read, or nullptr if none has been assigned.
+
+    */
+    const MipmappedWavetable* getWavetable() const noexcept
+    {
+        return oscWavetable;
+    }
+
+    /** Returns the level of the mip chain currently being read.
+
+    */
+    int getCurrentLevel() const noexcept
+    {
+        return currentLevel;
     }
 
     // =========================
     // ====== SAMPLE RATE ======
     // =========================
-    /** Sets the sample rate for this oscillator to render at.
+    /** Sets the table notes are tuned from, and so the sample rate the oscillator renders at.
 
-        Updates the tableDelta of the oscillator.
+        Only a pointer is kept: the table must stay alive, and unchanged while the oscillator is rendered.
+        Updates the frequency and tableDelta of the oscillator.
     */
-    void setSampleRate(double newSampleRate)
+    void setPitchTable(const PitchTable& newPitchTable)
     {
-        currentSampleRate = newSampleRate;
-        updateTableDelta();
+        pitchTable = &newPitchTable;
+        currentSampleRate = pitchTable->getSampleRate();
+        updateFrequency();
+
+        // Built here, before playback, so the audio thread never builds it
+        SincInterpolation::getCoefficients();
+    }
+
+    // ===========================
+    // ====== INTERPOLATION ======
+    // ===========================
+    /** Sets the kernel used to read between table samples. Takes effect from the next block.
+
+    */
+    void setInterpolation(InterpolationMode newMode) noexcept
+    {
+        interpolation = newMode;
+    }
+
+    InterpolationMode getInterpolation() const noexcept
+    {
+        return interpolation;
     }
 
 
@@ -143,84 +189,137 @@ public:
         updateFrequency();
     }
 
+    /** Sets the octave, coarse (semitone) and fine (cent) detune of the oscillator.
 
-    // ===========================
-    // ====== SAMPLE OUTPUT ======
-    // ===========================
-    /** Returns the next sample this oscillator should play.
+        Updates the frequency and tableDelta only if the detune has changed.
+    */
+    void setDetune(int octaveSteps, int coarseSteps, int fineSteps)
+    {
+        if (octaveSteps != octaveDetuneSteps || coarseSteps != coarseDetuneSteps || fineSteps != fineDetuneSteps)
+        {
+            octaveDetuneSteps = octaveSteps;
+            coarseDetuneSteps = coarseSteps;
+            fineDetuneSteps = fineSteps;
+
+            updateFrequency();
+        }
+    }
 
+    /** Sets the pitch bend, as a ratio of the detuned note's frequency, straight away. For the start of a note.
+
+    */
+    void setPitchRatio(double newRatio)
+    {
+        pitchRatio = newRatio;
+        updateTableDelta();
+    }
+
+    /** Glides the pitch bend ratio to newRatio across the next numSamples. Call once per block, before rendering it.
+
+        The increment ramps linearly through the block, so a bend costs an add per sample and nothing per event.
+        The mip level is picked for the higher end of the ramp, so nothing aliases on the way. Rendering the block
+        ends the ramp, landing the increment exactly on newRatio's, whatever the per-sample steps rounded to.
     */
-    forcedinline float getNextSample() noexcept
+    void rampPitchRatio(double newRatio, int numSamples) noexcept
     {
-        if (!isEnabled())
+        if (newRatio == pitchRatio && !pitchRamping)
         {
-            return 0.0f;
+            return;
         }
-        else
+
+        // Starts exactly where the last ramp was headed, whatever rounding it picked up
+        double startIncrement = noteIncrement * pitchRatio;
+        double endIncrement = noteIncrement * newRatio;
+
+        selectLevel(jmax(startIncrement, endIncrement));
+        phase.setIncrement(startIncrement);
+
+        pitchRatio = newRatio;
+        pitchRamping = endIncrement != startIncrement;
+
+        if (pitchRamping)
         {
-            if (hasDelta())
-            {
-                int index0 = (unsigned int)currentIndex;
-                int index1 = index0 + 1;
+            phase.rampIncrement(endIncrement, numSamples);
+        }
+    }
 
-                float frac = currentIndex - (float)index0;
 
-                auto* table = oscWavetable->getReadPointer(0);
-                float value0 = table[index0];
-                float value1 = table[index1];
+    // ===========================
+    // ====== SAMPLE OUTPUT ======
+    // ===========================
+    /** Adds the next numSamples of this oscillator, scaled by gain, into dest.
 
-                float currentSample = value0 + frac * (value1 - value0);
+        The table pointers and phase state are copied to locals once per block, and the kernel for the
+        interpolation mode and sample format is picked once per block, so the inner loop stays branch-free.
+    */
+    void renderBlock(float* dest, int numSamples, float gain) noexcept
+    {
+        withInterpolationKernel(interpolation, [&] (const auto& kernel)
+        {
+            renderWithFormat<false>(kernel, dest, nullptr, numSamples, gain, 0.0f);
+        });
+    }
 
-                if ((currentIndex += tableDelta) > tableSize)
-                {
-                    currentIndex -= tableSize;
-                }
+    /** Adds the next numSamples of this oscillator into left and right, scaled by each side's gain.
 
-                return currentSample;
-            }
-        }
-    } 
+    */
+    void renderBlock(float* left, float* right, int numSamples, float leftGain, float rightGain) noexcept
+    {
+        withInterpolationKernel(interpolation, [&] (const auto& kernel)
+        {
+            renderWithFormat<true>(kernel, left, right, numSamples, leftGain, rightGain);
+        });
+    }
+
+    /** Returns the gain of one side of a pan position, from -1 (left) to 1 (right).
 
-    float getCurrentIndex()
+        Uses a balance law: the centre is unity on both sides, so an unpanned stereo render matches a mono one,
+        and panning only turns the opposite side down.
+    */
+    static float getPanGain(float pan, bool rightSide) noexcept
     {
-        return currentIndex;
+        return jmin(1.0f, rightSide ? 1.0f + pan : 1.0f - pan);
     }
 
-    void setCurrentIndex(float newIndex)
+    /** Returns the phase engine, for inspecting the increment and any ramp of it.
+
+    */
+    const OscillatorPhase& getPhase() const noexcept
     {
-        currentIndex = newIndex;
+        return phase;
     }
 
-    /** Resets the currentIndex to 0.0 to play a new note
-        
+    /** Returns the position within the current cycle, from 0 to 1.
+
     */
-    void resetIndex()
+    double getCyclePosition() const noexcept
     {
-        currentIndex = 0.0f;
+        return phase.getCyclePosition();
     }
 
+    void setCyclePosition(double newPosition) noexcept
+    {
+        phase.setCyclePosition(newPosition);
+    }
 
-    // =======================
-    // ====== LISTENERS ======
-    // =======================
-    /**
-    
+    /** Resets the phase to 0.0 to play a new note
+        
     */
-    void valueTreePropertyChanged(ValueTree& treeWhosePropertyHasChanged, const Identifier& property) override
+    void resetIndex()
     {
-        // Detune parameters
-        if (treeWhosePropertyHasChanged == oscParams.getChildWithName(IDs::DETUNE))
-        {
-            updateFrequency();
-        }
+        phase.reset();
     }
 
+
 private:
-    // The value tree containing parameters for this oscillator
-    ValueTree oscParams;
+    // Lanes read and write the phase and table of each oscillator directly when rendering them together
+    friend class OscillatorLanes;
 
     // Oscillator index. Stored locally for consistency
-    int oscNumber;
+    int oscNumber = 0;
+
+    // Tunes each note for the sample rate. Owned by the processor
+    const PitchTable* pitchTable = nullptr;
 
     // Current sample rate to be played at. Stored locally for efficiency
     double currentSampleRate = -1.0;
@@ -228,9 +327,36 @@ private:
     // =======================
     // ====== WAVETABLE ======
     // =======================
-    std::shared_ptr<AudioBuffer<float>> oscWavetable;
+    // Non-owning, so copying oscillators between banks costs no reference counting
+    const MipmappedWavetable* oscWavetable = nullptr;
+
+    // The level of the mip chain being read, chosen from the frequency and sample rate
+    int currentLevel = 0;
     int tableSize = 0;
-    float currentIndex = 0.0f;
+
+    // The two frames of the current level either side of the frame position, and how far to mix from the first to the second.
+    // Single-frame tables read the same frame twice, with no mix. Samples are in the table's format
+    const void* levelData = nullptr;
+    const void* nextFrameData = nullptr;
+    float frameMix = 0.0f;
+
+    // What each frame's decoded samples are multiplied by. Always 1 for float32 tables
+    float levelScale = 1.0f;
+    float nextFrameScale = 1.0f;
+
+    WavetableSampleFormat sampleFormat = WavetableSampleFormat::float32;
+
+    InterpolationMode interpolation = InterpolationMode::linear;
+
+    // Smoothed and target frame positions, from 0 to 1
+    float framePosition = 0.0f;
+    float targetFramePosition = 0.0f;
+
+    // Time for the frame position to glide most of the way to a new target
+    static constexpr double framePositionSmoothingSeconds = 0.02;
+
+    // Position in the cycle and step per sample. Fixed or floating point, depending on SYNTHFRAMEWORK_FIXED_POINT_PHASE
+    OscillatorPhase phase;
 
 
     // ===========================
@@ -240,85 +366,262 @@ private:
     int currentNote = -1;
 
     // 12st per step
-    CachedValue<int> octaveDetuneSteps;
+    int octaveDetuneSteps = 0;
     // 1st per step
-    CachedValue<int> coarseDetuneSteps;
+    int coarseDetuneSteps = 0;
     // 1/100st per step
-    CachedValue<int> fineDetuneSteps;
+    int fineDetuneSteps = 0;
 
-    // The frequency being played. This will be updated based on currentNote & detune
-    double currentFrequency = -1.0;
+    // Cycles per sample of the detuned note, before pitch bend. Updated based on currentNote & detune
+    double noteIncrement = 0.0;
 
-    // The rate through which the wavetable will be stepped to produce samples.
-    // This will be updated when any changes to frequency or sample rate occur.
-    float tableDelta = 0.0;
+    // Pitch bend, as a ratio of noteIncrement, and whether the increment is ramping towards it during this block
+    double pitchRatio = 1.0;
+    bool pitchRamping = false;
 
     //==============================================================================
-    /** Called to initialise cached detune values.
-    
+    /** Updates or resets noteIncrement based on the note being played & the oscillator's detune settings.
+
+        Calls updateTableDelta to propogate frequency update.
+    */
+    void updateFrequency()
+    {
+        // Reset frequency
+        if (currentNote == -1 || pitchTable == nullptr)
+        {
+            noteIncrement = 0.0;
+        }
+        // Look up the note, adjusted by octave and coarse detunes, then apply the fine detune in cents
+        else
+        {
+            int coarseAdjustedNote = currentNote + (octaveDetuneSteps * 12) + coarseDetuneSteps;
+
+            noteIncrement = pitchTable->getNoteIncrement(coarseAdjustedNote) * PitchTable::getCentsRatio(fineDetuneSteps);
+        }
+
+        updateTableDelta();
+    }
+
+    /** Picks the mip level with the most harmonics that won't alias at an increment of cyclesPerSample.
+
+        The phase keeps its position in the cycle if the level size changes.
     */
-    void initDetune()
+    void selectLevel(double cyclesPerSample)
     {
-        ValueTree& detune = oscParams.getChildWithName(IDs::DETUNE);
+        currentLevel = oscWavetable->getLevelIndexForFrequency(cyclesPerSample * currentSampleRate, currentSampleRate);
+        tableSize = oscWavetable->getLevelSize(currentLevel);
+
+        updateFramePointers();
+
+        phase.setTableSize(tableSize);
+    }
+
+    /** Points levelData and nextFrameData at the frames of the current level either side of the frame position.
 
-        octaveDetuneSteps.referTo(detune, IDs::detuneOctave, nullptr);
-        coarseDetuneSteps.referTo(detune, IDs::detuneCoarse, nullptr);
-        fineDetuneSteps.referTo(detune, IDs::detuneFine, nullptr);
+    */
+    void updateFramePointers() noexcept
+    {
+        int numFrames = oscWavetable->getNumFrames();
+        sampleFormat = oscWavetable->getSampleFormat();
 
-        if (currentNote != -1)
+        if (numFrames == 1)
         {
-            updateFrequency();
+            levelData = oscWavetable->getLevelData(currentLevel);
+            nextFrameData = levelData;
+            levelScale = oscWavetable->getFrameScale(currentLevel);
+            nextFrameScale = levelScale;
+            frameMix = 0.0f;
+            return;
         }
+
+        float scaledPosition = framePosition * (float)(numFrames - 1);
+        int frame = jmin((int)scaledPosition, numFrames - 2);
+
+        levelData = oscWavetable->getLevelData(currentLevel, frame);
+        nextFrameData = oscWavetable->getLevelData(currentLevel, frame + 1);
+        levelScale = oscWavetable->getFrameScale(currentLevel, frame);
+        nextFrameScale = oscWavetable->getFrameScale(currentLevel, frame + 1);
+        frameMix = scaledPosition - (float)frame;
     }
 
-    //==============================================================================
-    /** Updates or resets currentFrequency based on the note being played & the oscillator's detune settings.
+    /** Renders with the kernel for the table's sample format, and for whether it's between frames.
 
-        Calls updateTableDelta to propogate frequency update.
     */
-    void updateFrequency()
+    template <bool stereo, typename Kernel>
+    void renderWithFormat(const Kernel& kernel, float* left, float* right, int numSamples, float leftGain, float rightGain) noexcept
     {
-        // Reset frequency
-        if (currentNote == -1)
+        switch (sampleFormat)
         {
-            currentFrequency = -1.0;
+            case WavetableSampleFormat::int16:
+                renderWithMorphing<WavetableSampleFormat::int16, stereo>(kernel, left, right, numSamples, leftGain, rightGain);
+                break;
+
+            case WavetableSampleFormat::float16:
+                renderWithMorphing<WavetableSampleFormat::float16, stereo>(kernel, left, right, numSamples, leftGain, rightGain);
+                break;
+
+            case WavetableSampleFormat::float32:
+            default:
+                renderWithMorphing<WavetableSampleFormat::float32, stereo>(kernel, left, right, numSamples, leftGain, rightGain);
+                break;
+        }
+    }
+
+    template <WavetableSampleFormat format, bool stereo, typename Kernel>
+    void renderWithMorphing(const Kernel& kernel, float* left, float* right, int numSamples, float leftGain, float rightGain) noexcept
+    {
+        if (frameMix == 0.0f)
+        {
+            renderSamples<format, false, stereo>(kernel, left, right, numSamples, leftGain, rightGain);
         }
-        // Calculate frequency from note
         else
         {
-            // Adjust note by octave and coarse detunes
-            int coarseAdjustedNote = currentNote + (octaveDetuneSteps * 12) + coarseDetuneSteps;
+            renderSamples<format, true, stereo>(kernel, left, right, numSamples, leftGain, rightGain);
+        }
+    }
+
+    /** Adds numSamples into left, and into right in stereo, scaled by each side's gain.
+
+        When morphing, both frames are interpolated at the same position and then mixed. Compact formats, and kernels
+        wider than linear, are rendered four output samples at a time with SSE2, decoding as they're read.
+    */
+    template <WavetableSampleFormat format, bool morphing, bool stereo, typename Kernel>
+    void renderSamples(const Kernel& kernel, float* left, float* right, int numSamples, float leftGain, float rightGain) noexcept
+    {
+        if (!hasDelta())
+        {
+            return;
+        }
 
-            // Get frequency for coarse adjusted note
-            double noteFreq = MidiMessage::getMidiNoteInHertz(coarseAdjustedNote);
+        using SampleType = typename WavetableSampleTraits<format>::Type;
+        constexpr bool scaled = format != WavetableSampleFormat::float32;
 
-            // TODO pitch by cents for fine adjustment
+        FrameReader<format> reader { static_cast<const SampleType*>(levelData) };
+        FrameReader<format> nextReader { static_cast<const SampleType*>(nextFrameData) };
+        float mix = frameMix;
+        float scale = levelScale;
+        float nextScale = nextFrameScale;
+        OscillatorPhase blockPhase = phase;
 
-            currentFrequency = noteFreq;
+        int i = 0;
+
+       #if SYNTHFRAMEWORK_SSE2
+        constexpr bool vectorised = scaled || Kernel::tapsBefore + Kernel::tapsAfter > 1;
+
+        if (vectorised)
+        {
+            __m128 scales = _mm_set1_ps(scale);
+            __m128 nextScales = _mm_set1_ps(nextScale);
+            __m128 mixes = _mm_set1_ps(mix);
+
+            for (; i + 4 <= numSamples; i += 4)
+            {
+                alignas(16) int32 indices[4];
+                alignas(16) float fracs[4];
+
+                for (int k = 0; k < 4; ++k)
+                {
+                    indices[k] = blockPhase.getIndex();
+                    fracs[k] = blockPhase.getFraction();
+                    blockPhase.advance();
+                }
+
+                __m128i index = _mm_load_si128((const __m128i*)indices);
+                __m128 frac = _mm_load_ps(fracs);
+
+                __m128 value = kernel.interpolate4(reader, index, frac);
+
+                if (scaled)
+                {
+                    value = _mm_mul_ps(value, scales);
+                }
+
+                if (morphing)
+                {
+                    __m128 next = kernel.interpolate4(nextReader, index, frac);
+
+                    if (scaled)
+                    {
+                        next = _mm_mul_ps(next, nextScales);
+                    }
+
+                    value = _mm_add_ps(value, _mm_mul_ps(mixes, _mm_sub_ps(next, value)));
+                }
+
+                _mm_storeu_ps(left + i, _mm_add_ps(_mm_loadu_ps(left + i), _mm_mul_ps(value, _mm_set1_ps(leftGain))));
+
+                if (stereo)
+                {
+                    _mm_storeu_ps(right + i, _mm_add_ps(_mm_loadu_ps(right + i), _mm_mul_ps(value, _mm_set1_ps(rightGain))));
+                }
+            }
         }
+       #endif
 
-        updateTableDelta();
+        for (; i < numSamples; ++i)
+        {
+            int index0 = blockPhase.getIndex();
+            float frac = blockPhase.getFraction();
+
+            float value = kernel.interpolate(reader, index0, frac);
+
+            if (scaled)
+            {
+                value *= scale;
+            }
+
+            if (morphing)
+            {
+                float next = kernel.interpolate(nextReader, index0, frac);
+
+                if (scaled)
+                {
+                    next *= nextScale;
+                }
+
+                value += mix * (next - value);
+            }
+
+            left[i] += leftGain * value;
+
+            if (stereo)
+            {
+                right[i] += rightGain * value;
+            }
+
+            blockPhase.advance();
+        }
+
+        phase = blockPhase;
+        finishPitchRamp();
     }
 
-    /** Updates or resets the tableDelta given the current sample rate and frequency.
-        
-        Called by setSampleRate and setFrequency.
+    /** Ends a pitch ramp once its block has been rendered, holding the increment exactly at the ramp's target.
+
     */
-    void updateTableDelta()
+    void finishPitchRamp() noexcept
     {
-        // Reset delta
-        if (currentSampleRate == -1.0 || currentFrequency == -1.0)
+        if (pitchRamping)
         {
-            tableDelta = 0.0;
-        }
-        // Calculate new delta
-        else
-        {
-            double tableSizeOverSampleRate = (double)tableSize / currentSampleRate;
-            tableDelta = currentFrequency * tableSizeOverSampleRate;
+            updateTableDelta();
         }
     }
 
+    /** Updates or resets the phase increment given the note's increment and the pitch bend, ending any ramp.
+        
+        Called by updateFrequency and setPitchRatio. Selects the mip level to read first, as a float phase's increment depends on its size.
+        The increment is 0, so the oscillator can't play, until both a pitch table and a note are set.
+    */
+    void updateTableDelta()
+    {
+        double increment = noteIncrement * pitchRatio;
+
+        selectLevel(increment);
+        phase.setIncrement(increment);
+
+        pitchRamping = false;
+    }
+
 
     //==============================================================================
 };
\ No newline at end of file
@@ -14,46 +14,28 @@
 #include "Common.h"
 #include "PluginProcessor.h"
 #include "SynthVoice.h"
-#include "WavetableOscillator.h"
+#include "OscillatorBank.h"
+#include "BlockEnvelope.h"
+#include "SilenceDetector.h"
 
 
 //==================================================================================
 /** Manages a set of Oscillators.
 
+    Never touches the value tree. Which oscillators exist arrives as an OscillatorSet through
+    applyOscillatorSet, and their parameters through the processor's parameter snapshot.
 */
-class WavetableOscillatorManager : public ValueTree::Listener
+class WavetableOscillatorManager
 {
 public:
-    // Manager constructed from tree containing its parameters, the processor controlling the synth, and the voice that owns it
-    WavetableOscillatorManager(ValueTree oscMgrParams, SynthFrameworkAudioProcessor& p, SynthVoice& v)
-        : oscManagerParams (oscMgrParams),
-          oscTree (oscManagerParams.getChildWithName(IDs::OSC_GROUP)),
-          processor (p),
+    // Manager constructed from the processor controlling the synth, and the voice that owns it
+    WavetableOscillatorManager(SynthFrameworkAudioProcessor& p, SynthVoice& v)
+        : processor (p),
           voice (v)
     {
-        oscManagerParams.addListener(this);
-
-        gainEnv = std::make_unique<ADSR>();
-        filterEnv = std::make_unique<ADSR>();
-
-        tempGainEnv = std::make_unique<ADSR>();
-        tempFilterEnv = std::make_unique<ADSR>();
-
         setSampleRate(voice.getSampleRate());
     }
 
-    ~WavetableOscillatorManager()
-    {
-        oscManagerParams.removeListener(this);
-
-        oscillators.clear();
-        tempOscillators.clear();
-
-        gainEnv.reset(nullptr);
-
-        filterEnv.reset(nullptr);
-    }
-
     // ======================================
     // ====== PROCESSOR & VOICE ACCESS ======
     // ======================================
@@ -66,13 +48,7 @@ public:
     {
         currentNote = note;
 
-        int numOsc = oscillators.size();
-        jassert(numOsc == oscTree.getNumChildren());
-
-        for (int i = 0; i < numOsc; ++i)
-        {
-            oscillators[i]->setNote(currentNote);
-        }
+        oscillators.setNote(currentNote);
     }
 
     /** Returns the midi note number currently being played by this manager.
@@ -83,8 +59,17 @@ public:
         return currentNote;
     }
 
+    /** Returns the level of the last gain envelope sample rendered, scaled by velocity.
+
+    */
+    float getCurrentLevel() const noexcept
+    {
+        return gainEnv.getLevel() * vLevel;
+    }
+
     /** Sets the sample rate of all oscillators.
 
+        Oscillators are tuned from the processor's pitch table, which prepareToPlay sets to the same rate before the voices.
     */
     void setSampleRate(double sampleRate)
     {
@@ -94,119 +79,177 @@ public:
             // Update local variable
             currentSampleRate = sampleRate;
 
-            // Update oscillators
-            int numOsc = oscillators.size();
-
-            //jassert(numOsc == oscTree.getNumChildren());
+            jassert(currentSampleRate <= 0.0 || processor.getPitchTable().getSampleRate() == currentSampleRate);
 
-            for (int i = 0; i < numOsc; ++i)
-            {
-                oscillators[i]->setSampleRate(currentSampleRate);
-                tempOscillators[i]->setSampleRate(currentSampleRate);
-            }
+            // Update oscillators
+            oscillators.setPitchTable(processor.getPitchTable());
 
-            // Protects against invalid calls to ADSR.setSampleRate
+            // Protects against invalid calls to BlockEnvelope.setSampleRate
             if (currentSampleRate > 0.0)
             {
                 // Update envelopes
-                gainEnv->setSampleRate(currentSampleRate);
-                filterEnv->setSampleRate(currentSampleRate);
+                gainEnv.setSampleRate(currentSampleRate);
+                filterEnv.setSampleRate(currentSampleRate);
             }
 
+            updateSilenceHold();
+
         }
     }
 
-    /** Returns the sum of next samples of all oscillators.
+    /** Sets the largest block that renderBlock will be asked to produce.
 
+        Allocates the scratch buffers the oscillators and envelopes are rendered into, so must not be called from the audio thread.
     */
-    float getNextSample()
+    void setMaximumBlockSize(int maximumBlockSize)
     {
-        float value = 0.0f;
+        oscillatorBuffer.setSize(2, maximumBlockSize, false, false, true);
+        envelopeBuffer.setSize(1, maximumBlockSize, false, false, true);
+    }
 
-        if (isEnabled() && currentNote != -1)
+    /** Adds the sum of all oscillators for the next numSamples into left, scaled by the gain envelope.
+
+        If right isn't null, the oscillators are panned between left and right instead.
+        numSamples must not exceed the size passed to setMaximumBlockSize.
+    */
+    void renderBlock(float* left, float* right, int numSamples)
+    {
+        if (prepareBlock(numSamples))
         {
-            // ==========================
-            // ====== CURRENT NOTE ======
-            // ==========================
-            if (!gainEnv->isActive())
-            {
-                resetOscillators(oscillators);
-                gainEnv->reset();
+            renderOscillators(oscillators, envelopeBuffer.getReadPointer(0), left, right, numSamples);
 
-                releasing = false;
-                setNote(-1);
-                voice.clear();
-            }
-            else
+            // Rendered alone, the output can be measured rather than bounded. Only worth it once the envelope is quiet
+            if (envelopeBelowFloor)
             {
-                int numOsc = oscillators.size();
-                jassert(numOsc == oscTree.getNumChildren());
+                blockOutputPeak = getPeak(left, numSamples);
 
-                // Sum each active oscillator's next sample
-                for (int i = 0; i < numOsc; ++i)
+                if (right != nullptr)
                 {
-                    if (oscTree.getChild(i).getProperty(IDs::enabled))
-                    {
-                        value += oscillators[i]->getNextSample() * vLevel;
-                    }
+                    blockOutputPeak = jmax(blockOutputPeak, getPeak(right, numSamples));
                 }
+            }
 
-                currentGainEnvLevel = gainEnv->getNextSample();
+            finishBlock();
+        }
+    }
 
-                // Scale by envelope value
-                value *= currentGainEnvLevel;
-            }
+    /** Returns true if any playing oscillator is panned, so the manager should be rendered in stereo.
 
-            // =========================
-            // ====== FADING NOTE ======
-            // =========================
-            if (fading)
-            {
-                if (!tempGainEnv->isActive())
-                {
-                    // Reset temp members for new fade
-                    clearFade();
+        Picks up any parameter changes first, so the answer is current for the next block.
+    */
+    bool isPanned()
+    {
+        updateParameters();
 
-                    // End fade
-                    fading = false;
-                }
-                else
-                {
-                    int numOsc = tempOscillators.size();
-
-                    // Sum each active tempOscillator's next sample
-                    float value2 = 0.0f;
-                    for (int i = 0; i < numOsc; ++i)
-                    {
-                        if (oscTree.getChild(i).getProperty(IDs::enabled))
-                        {
-                            value2 += tempOscillators[i]->getNextSample() * tempVLevel;
-                        }
-                    }
-
-                    // Scale by tempEnvelope value
-                    value2 *= tempGainEnv->getNextSample();
-
-                    // Add to return value
-                    value += value2;
-                }
-            }
+        return oscillators.isPanned();
+    }
+
+   #if SYNTHFRAMEWORK_SSE_LANES
+    /** Adds a lane for each playing oscillator to lanes, so the manager's oscillators can be rendered with other voices'.
+
+        If this returns true, finishBlock must be called once lanes has been rendered.
+    */
+    bool addToLanes(OscillatorLanes& lanes, int numSamples)
+    {
+        if (!prepareBlock(numSamples))
+        {
+            return false;
         }
 
-        return value;
+        // Every manager reads the same snapshot, so whichever voice packs its lanes last agrees with the rest
+        lanes.setInterpolation(interpolation);
+        oscillators.addToLanes(lanes, 1.0f, envelopeBuffer.getReadPointer(0));
+
+        return true;
     }
+   #endif
 
-    /** Resets all oscillators to play a new note.
+    /** Applies parameter changes and renders the gain envelope for the next numSamples, scaled by the note's velocity.
 
+        Returns false if there is nothing to play, in which case finishBlock shouldn't be called.
     */
-    void resetOscillators(std::vector<std::unique_ptr<WavetableOscillator>>& oscArray)
+    bool prepareBlock(int numSamples)
     {
-        int numOsc = oscArray.size();
+        updateParameters();
 
-        for (int i = 0; i < numOsc; ++i)
+        if (!isEnabled() || currentNote == -1)
         {
-            oscArray[i]->resetIndex();
+            return false;
         }
+
+        jassert(numSamples <= envelopeBuffer.getNumSamples());
+
+        // The bend glides across the block from one lookup, shared by every oscillator
+        oscillators.advanceFramePositions(numSamples);
+        oscillators.rampPitchRatio(getPitchWheelRatio(), numSamples);
+
+        // Outside its attack, the envelope can only hold or fall during the block, so its first sample is its peak
+        bool envelopeFalling = !gainEnv.isInAttack();
+
+        // The envelope renders the whole block at once
+        float* envelope = envelopeBuffer.getWritePointer(0);
+        gainEnv.renderBlock(envelope, numSamples, vLevel);
+
+        envelopeBelowFloor = envelopeFalling && envelope[0] < silenceFloor;
+        numBlockSamples = numSamples;
+
+        // Each oscillator peaks at 1, which bounds the output until it's measured
+        blockOutputPeak = envelope[0] * (float)oscillators.getNumEnabledOscillators();
+
+        return true;
+    }
+
+    /** Ends a note whose envelope finished during the block just rendered, or that has been silent for long enough.
+
+    */
+    void finishBlock()
+    {
+        bool silent = envelopeBelowFloor && blockOutputPeak < silenceFloor;
+
+        // Still sounding, but too quietly to hear, and can only get quieter before the next note
+        bool retire = silenceDetector.addBlock(silent, numBlockSamples) && gainEnv.isActive();
+
+        if (retire)
+        {
+            processor.countVoiceRetirement();
+        }
+
+        // Current note has finished its release, or is being retired
+        if (!gainEnv.isActive() || retire)
+        {
+            silenceDetector.reset();
+
+            oscillators.resetPhases();
+            gainEnv.reset();
+
+            releasing = false;
+            setNote(-1);
+            voice.clear();
+        }
+    }
+
+    /** Adds a block from each enabled oscillator in bank into left (and right, if not null), scaled by envelope.
+
+    */
+    void renderOscillators(OscillatorBank& bank, const float* envelope, float* left, float* right, int numSamples)
+    {
+        float* oscLeft = oscillatorBuffer.getWritePointer(0);
+        FloatVectorOperations::clear(oscLeft, numSamples);
+
+        if (right == nullptr)
+        {
+            bank.renderBlock(oscLeft, numSamples, 1.0f);
+        }
+        else
+        {
+            float* oscRight = oscillatorBuffer.getWritePointer(1);
+            FloatVectorOperations::clear(oscRight, numSamples);
+
+            bank.renderBlockStereo(oscLeft, oscRight, numSamples, 1.0f);
+            FloatVectorOperations::addWithMultiply(right, oscRight, envelope, numSamples);
+        }
+
+        FloatVectorOperations::addWithMultiply(left, oscLeft, envelope, numSamples);
     }
 
     /** Returns true if the oscillator manager is enabled.
@@ -214,7 +257,85 @@ public:
     */
     bool isEnabled()
     {
-        return oscManagerParams.getProperty(IDs::enabled);
+        return processor.getParameterSnapshot().managerEnabled;
+    }
+
+    /** Applies the processor's current parameter snapshot if it has changed since it was last applied.
+
+        Called from the audio thread before any rendering or note event.
+    */
+    void updateParameters()
+    {
+        const ParameterSnapshot& params = processor.getParameterSnapshot();
+
+        if (params.version != appliedParameterVersion)
+        {
+            appliedParameterVersion = params.version;
+
+            interpolation = params.interpolation;
+            oscillators.setInterpolation(interpolation);
+
+            pitchBendRange = params.pitchBendRange;
+
+            silenceFloor = params.silenceFloor;
+            silenceTime = params.silenceTime;
+            updateSilenceHold();
+
+            // Envelopes
+            if (params.hasGainEnvelope)
+            {
+                gainEnvParameters = params.gainEnvelope;
+                gainEnv.setParameters(gainEnvParameters);
+            }
+
+            if (params.hasFilterEnvelope)
+            {
+                filterEnvParameters = params.filterEnvelope;
+                filterEnv.setParameters(filterEnvParameters);
+            }
+
+            // The snapshot's oscillators are listed in the order of a particular OscillatorSet. If the banks
+            // haven't caught up with that set yet, try again once they have
+            if (params.oscillatorSetVersion != appliedOscillatorSetVersion)
+            {
+                appliedParameterVersion = 0;
+                return;
+            }
+
+            // Oscillator enabled state & detune. Each oscillator only recalculates its frequency if its own detune changed
+            int numOsc = jmin(oscillators.getNumOscillators(), params.numOscillators);
+
+            for (int i = 0; i < numOsc; ++i)
+            {
+                const OscillatorSnapshot& oscParams = params.oscillators[i];
+
+                oscillators.setEnabled(i, oscParams.enabled);
+                oscillators.setPan(i, oscParams.pan);
+                oscillators.getOscillator(i).setDetune(oscParams.detuneOctave, oscParams.detuneCoarse, oscParams.detuneFine);
+                oscillators.getOscillator(i).setFramePosition(oscParams.framePosition);
+            }
+        }
+    }
+
+    /** Adds, removes, moves and changes the wavetables of oscillators to match set, if it's newer than the last set applied.
+
+        Called from the audio thread at the start of a block, and never allocates. Parameters are re-applied
+        afterwards, as oscillators may have changed places.
+    */
+    void applyOscillatorSet(const OscillatorSet& set)
+    {
+        if (set.version == appliedOscillatorSetVersion)
+        {
+            return;
+        }
+
+        // New oscillators join the current note. Notes fading out are kept up to date by the processor's fade pool
+        oscillators.applyOscillatorSet(set, processor.getPitchTable(), currentNote);
+
+        appliedOscillatorSetVersion = set.version;
+        appliedParameterVersion = 0;
+
+        updateParameters();
     }
 
 
@@ -226,19 +347,23 @@ public:
     */
     void startNote(int midiNoteNumber, float velocity, int currentPitchWheelPosition)
     {
+        updateParameters();
+
+        pitchWheelPosition = currentPitchWheelPosition;
+
         // Currently playing a note
         if (currentNote != -1)
         {
             // For handling portamento and legato, no fade is necessary
             if (smoothSteal)
             {
-                var stealMode = oscManagerParams.getProperty(IDs::voiceStealMode);
+                VoiceStealMode stealMode = processor.getParameterSnapshot().voiceStealMode;
 
-                if (stealMode == "PORTAMENTO")
+                if (stealMode == VoiceStealMode::portamento)
                 {
                     setNote(midiNoteNumber);
                 }
-                else if (stealMode == "LEGATO")
+                else if (stealMode == VoiceStealMode::legato)
                 {
                     // TODO gradually shift frequency
                 }
@@ -249,16 +374,15 @@ public:
             // Fade between notes quickly
             else
             {
-                // Move main parameters to temp
+                // Hand the current note to the fade pool
                 initFade();
 
-                // Set note to fade into
+                // Set note to fade into, starting at the current bend rather than gliding to it
+                oscillators.setPitchRatio(getPitchWheelRatio());
                 setNote(midiNoteNumber);
 
                 // Begin envelope of new note
-                gainEnv->noteOn();
-
-                fading = true;
+                gainEnv.noteOn();
             }
         }
         // Not currently playing a note
@@ -266,24 +390,36 @@ public:
         {
             vLevel = velocity * 0.5f;
 
+            oscillators.setPitchRatio(getPitchWheelRatio());
             setNote(midiNoteNumber);
 
-            gainEnv->noteOn();
+            gainEnv.noteOn();
         }
     }
 
+    /** Sets the pitch wheel position, from 0 to 16383 with 8192 in the centre.
+
+        Only stored: the next block glides to the new bend, however many times the wheel moved before it.
+    */
+    void pitchWheelMoved(int newPitchWheelValue) noexcept
+    {
+        pitchWheelPosition = newPitchWheelValue;
+    }
+
     /** Releases the current note.
     
     */
     void stopNote(float velocity, bool allowTailOff)
     {
+        updateParameters();
+
         // Only stop if currently playing
         if (currentNote != -1)
         {
             if (!releasing)
             {
                 // Voice is being stolen and transition can be handled smoothly
-                if (!allowTailOff && oscManagerParams.getProperty(IDs::voiceStealMode) != "NORMAL")
+                if (!allowTailOff && processor.getParameterSnapshot().voiceStealMode != VoiceStealMode::normal)
                 {
                     smoothSteal = true;
                 }
@@ -291,7 +427,7 @@ public:
                 else
                 {
                     // Begin release
-                    gainEnv->noteOff();
+                    gainEnv.noteOff();
                     releasing = true;
                 }
             }
@@ -301,164 +437,6 @@ public:
         }
     }
 
-    // =======================
-    // ====== LISTENERS ======
-    // =======================
-    void valueTreePropertyChanged(ValueTree& treeWhosePropertyHasChanged, const Identifier& property) override
-    {
-        // OscillatorGroup parameters
-        if (treeWhosePropertyHasChanged == oscManagerParams.getChildWithName(IDs::OSC_GROUP))
-        {
-
-        }
-        // One of the oscillators' parameters has changed
-        else if (treeWhosePropertyHasChanged.getParent() == oscTree)
-        {
-            // TODO make oscillator self-sufficient and update wavetable through its own listener,
-            // TODO or remove wavetable change listeners altogether and only pass through synthsound
-
-            // In the manager, we only care about changes to oscillator wavetables.
-            // All other parameters are monitored by the oscillators themselves
-            if (property == IDs::waveType)
-            {
-                ValueTree& osc = treeWhosePropertyHasChanged;
-                int oscIndex = osc.getParent().indexOf(osc);
-
-                std::shared_ptr<AudioBuffer<float>> newWavetable = processor.getWavetablePtrFromType(osc[IDs::waveType]);
-
-                oscillators[oscIndex]->setWavetable(newWavetable);
-                tempOscillators[oscIndex]->setWavetable(std::move(newWavetable));
-            }
-        }
-        // Gain envelope parameters if the parameter value tree contains them
-        else if (treeWhosePropertyHasChanged == oscManagerParams.getChildWithProperty(IDs::target, "GAIN"))
-        {
-            jassert(currentSampleRate != -1.0);
-
-            if (property == IDs::attack)
-            {
-                gainEnvParameters.attack = treeWhosePropertyHasChanged.getProperty(IDs::attack);
-            }
-            else if (property == IDs::decay)
-            {
-                gainEnvParameters.decay = treeWhosePropertyHasChanged.getProperty(IDs::decay);
-            }
-            else if (property == IDs::sustain)
-            {
-                gainEnvParameters.sustain = treeWhosePropertyHasChanged.getProperty(IDs::sustain);
-            }
-            else if (property == IDs::release)
-            {
-                gainEnvParameters.release = treeWhosePropertyHasChanged.getProperty(IDs::release);
-            }
-
-            // Set new parameters on the envelope
-            gainEnv->setParameters(gainEnvParameters);
-        }
-        // Filter envelope parameters if the parameter value tree contains them
-        else if (treeWhosePropertyHasChanged == oscManagerParams.getChildWithProperty(IDs::target, "FILTER"))
-        {
-            jassert(currentSampleRate != -1.0);
-
-            if (property == IDs::attack)
-            {
-                filterEnvParameters.attack = treeWhosePropertyHasChanged.getProperty(IDs::attack);
-            }
-            else if (property == IDs::decay)
-            {
-                filterEnvParameters.decay = treeWhosePropertyHasChanged.getProperty(IDs::decay);
-            }
-            else if (property == IDs::sustain)
-            {
-                filterEnvParameters.sustain = treeWhosePropertyHasChanged.getProperty(IDs::sustain);
-            }
-            else if (property == IDs::release)
-            {
-                filterEnvParameters.release = treeWhosePropertyHasChanged.getProperty(IDs::release);
-            }
-
-            // Set new properties on the envelope
-            filterEnv->setParameters(filterEnvParameters);
-        }
-    }
-
-    void valueTreeChildAdded(ValueTree& parentTree, ValueTree& childWhichHasBeenAdded)
-    {
-        if (parentTree == oscManagerParams)
-        {
-            // New envelope
-            if (childWhichHasBeenAdded.getType() == IDs::ENVELOPE)
-            {
-                var targ = childWhichHasBeenAdded.getProperty(IDs::target);
-
-                if (targ == "GAIN")
-                {
-                    // Add a gain envelope to the scope of the manager
-                    // TODO
-                    
-                }
-                else if (targ == "FILTER")
-                {
-                    // Add a filter envelope to the scope of the manager
-                    // TODO
-
-                }
-            }
-        }
-        // New oscillator
-        else if (parentTree == oscManagerParams.getChildWithName(IDs::OSC_GROUP))
-        {
-            var wavetype = childWhichHasBeenAdded[IDs::waveType];
-
-            // Get a shared pointer to the wavetable the new oscillator should use
-            std::shared_ptr<AudioBuffer<float>> wavetableToPass = processor.getWavetablePtrFromType(wavetype);
-
-            // Create new unique ptrs to two identical oscillators (one main, one for fade)
-            auto newOsc = std::make_unique<WavetableOscillator>(childWhichHasBeenAdded, wavetableToPass);
-            auto newTempOsc = std::make_unique<WavetableOscillator>(childWhichHasBeenAdded, std::move(wavetableToPass));
-
-            // Init sample rates of new oscillators
-            newOsc->setSampleRate(currentSampleRate);
-            newTempOsc->setSampleRate(currentSampleRate);
-
-            // Ignore note of tempOsc, as that will be handled during a fade
-            newOsc->setNote(currentNote);
-
-            // Move oscillators into vectors
-            oscillators.push_back(std::move(newOsc));
-            tempOscillators.push_back(std::move(newTempOsc));
-        }
-    }
-
-    void valueTreeChildRemoved(ValueTree& parentTree, ValueTree& childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved)
-    {
-        if (parentTree == oscManagerParams)
-        {
-            // Envelope removed
-            if (childWhichHasBeenRemoved.getType() == IDs::ENVELOPE)
-            {
-                if (childWhichHasBeenRemoved.getProperty(IDs::target) == "GAIN")
-                {
-                    // Remove gain envelope from the scope of the manager
-                    // TODO
-
-                }
-                else if (childWhichHasBeenRemoved.getProperty(IDs::target) == "FILTER")
-                {
-                    // Remove filter envelope from the scope of the manager
-                    // TODO
-
-                }
-            }
-        }
-        // Oscillator removed
-        else if (parentTree == oscTree)
-        {
-            oscillators.erase(oscillators.begin() + indexFromWhichChildWasRemoved);
-            tempOscillators.erase(tempOscillators.begin() + indexFromWhichChildWasRemoved);
-        }
-    }
-
 
 private:
     //==============================================================================
@@ -470,44 +448,63 @@ private:
     SynthVoice& voice;
 
     //==============================================================================
-    // The parameters associated with this manager
-    ValueTree oscManagerParams;
-    ValueTree oscTree;
-
     double currentSampleRate = -1.0;
 
+    // Version of the last parameter snapshot applied by updateParameters
+    uint32 appliedParameterVersion = 0;
+
+    // Version of the last OscillatorSet applied by applyOscillatorSet
+    uint32 appliedOscillatorSetVersion = 0;
+
+    // The kernel from the last parameter snapshot, set on both banks and any shared lanes
+    InterpolationMode interpolation = InterpolationMode::linear;
+
+    // The last pitch wheel position, and the semitones either way it reaches at full deflection
+    int pitchWheelPosition = 8192;
+    int pitchBendRange = 2;
+
     //==============================================================================
     // =====================================
     // ====== OSCILLATORS & ENVELOPES ======
     // =====================================
-    std::vector<std::unique_ptr<WavetableOscillator>> oscillators;
+    // The oscillators playing the current note. A note being faded out is handed to the processor's FadePool
+    OscillatorBank oscillators;
+
     // The current note being played
     int currentNote = -1;
     // The current vLevel set by the velocity of the note press
     float vLevel = 0.0f;
 
-    // Envelopes
-    std::unique_ptr<ADSR> gainEnv = nullptr;
-    ADSR::Parameters gainEnvParameters;
-    std::unique_ptr<ADSR> filterEnv = nullptr;
-    ADSR::Parameters filterEnvParameters;
-
-    // A stored copy of the last gain envelope sample, for initiating fades
-    float currentGainEnvLevel = 0.0f;
+    // Envelopes, stored by value and rendered a block at a time
+    BlockEnvelope gainEnv;
+    BlockEnvelope::Parameters gainEnvParameters;
+    BlockEnvelope filterEnv;
+    BlockEnvelope::Parameters filterEnvParameters;
 
     // The time in seconds for a note to fade quickly
     float fastReleaseTime = 0.01f;
 
-    // ============================================
-    // ====== TEMPORARY VARIABLES FOR FADING ======
-    // ============================================
-    std::vector<std::unique_ptr<WavetableOscillator>> tempOscillators;
-    
-    float tempVLevel = 0.0f;
+    // Scratch space the oscillators are summed into before the envelope is applied
+    AudioBuffer<float> oscillatorBuffer;
+
+    // The gain envelope of the current note for the block being rendered, already scaled by velocity
+    AudioBuffer<float> envelopeBuffer;
+
+    // ===============================
+    // ====== SILENCE DETECTION ======
+    // ===============================
+    // From the last parameter snapshot: the gain a falling note must stay below for silenceTime seconds to be retired
+    float silenceFloor = 0.0f;
+    float silenceTime = 0.0f;
 
-    std::unique_ptr<ADSR> tempGainEnv = nullptr;
-    ADSR::Parameters tempGainEnvParameters;
-    std::unique_ptr<ADSR> tempFilterEnv = nullptr;
+    // Whether the envelope stays below silenceFloor for the whole block being rendered, and the block's output peak:
+    // measured when the manager renders alone, otherwise bounded from the envelope
+    bool envelopeBelowFloor = false;
+    float blockOutputPeak = 0.0f;
+
+    // Samples in the block being rendered, and how long the note has been below silenceFloor
+    int numBlockSamples = 0;
+    SilenceDetector silenceDetector;
 
     // Flag: current note is releasing
     bool releasing = false;
@@ -515,82 +512,56 @@ private:
     // Flag: voice steal requires no fade
     bool smoothSteal = false;
 
-    // Flag: fading between notes, sum both the main and temporary oscillators' samples
-    bool fading = false;
-
 
     //==============================================================================
     /** Initiates a fade between the current note and the new note.
 
-        Fills the temporary variables with copies of the main ones.
+        The current note's oscillators and envelope are copied into a slot of the processor's fade pool, which
+        releases them quickly, and this manager's are reset for the new note.
     */
     void initFade()
     {
-        // =========================================
-        // ====== COPY MAIN VARIABLES TO TEMP ======
-        // =========================================
-        int numOsc = oscillators.size();
-        jassert(numOsc == oscTree.getNumChildren());
-
-        // Swap oscillators with temp ones
-        for (int i = 0; i < numOsc; ++i)
-        {
-            oscillators[i].swap(tempOscillators[i]);
-        }
-        
-        // Swap envelopes with temp ones
-        tempGainEnv.swap(gainEnv);
-        tempFilterEnv.swap(filterEnv);
+        processor.getFadePool().startFade(oscillators, gainEnv, vLevel, fastReleaseTime);
+
+        // The new note starts from the beginning of its cycle
+        oscillators.resetPhases();
 
         // Set env params for new note
-        gainEnv->setParameters(gainEnvParameters);
-        gainEnv->reset();
+        gainEnv.setParameters(gainEnvParameters);
+        gainEnv.reset();
+        filterEnv.reset();
 
         // Whether or not the current note is releasing, set flag to false for the new note
         releasing = false;
+    }
 
-        // Create new parameters for an immediate fast release starting at the currentGainEnvlevel
-        tempGainEnvParameters.attack = 0.0f;
-        tempGainEnvParameters.decay = 0.0f;
-        tempGainEnvParameters.sustain = currentGainEnvLevel;
-        tempGainEnvParameters.release = fastReleaseTime;
-
-
-
-        // Set new parameters for fade, immediately release
-        tempGainEnv->setParameters(tempGainEnvParameters);
-        tempGainEnv->noteOff();
+    /** Converts the silence time to samples at the current rate. Retirement is off until there's a sample rate.
 
-        // Store previous vLevel for fade
-        tempVLevel = vLevel;
+    */
+    void updateSilenceHold() noexcept
+    {
+        silenceDetector.setHoldSamples(currentSampleRate > 0.0 ? roundToInt(silenceTime * currentSampleRate) : 0);
     }
 
-    // Clears the temporary variables after a fade is complete.
-    void clearFade()
-    {
-        // Reset temporary oscillators for a new fade
-        resetOscillators(tempOscillators);
+    /** Returns the frequency ratio of the pitch wheel's position. One table lookup, whatever the bend.
 
-        // Reset temporary envelopes for a new fade
-        tempGainEnv->reset();
-        tempFilterEnv->reset();
+    */
+    double getPitchWheelRatio() const noexcept
+    {
+        if (pitchWheelPosition == 8192)
+        {
+            return 1.0;
+        }
 
-        // Reset tempVLevel TODO might be unecessary
-        tempVLevel = -1.0f;
+        double cents = (double)(pitchWheelPosition - 8192) * (pitchBendRange * 100.0 / 8192.0);
+        return PitchTable::getCentsRatio(cents);
     }
-    
-    //==============================================================================
 
-    // Helper for updating oscillator indices after a wavetable has been removed
-    void updateOscillatorIndices(int indexRemovedFrom)
+    // The largest absolute sample in a block
+    static float getPeak(const float* samples, int numSamples) noexcept
     {
-        int numOsc = oscillators.size();
-        jassert(numOsc == oscTree.getNumChildren());
-
-        for (int i = indexRemovedFrom; i < numOsc; ++i)
-        {
-            oscillators[i]->setOscNumber(i);
-        }
+        auto range = FloatVectorOperations::findMinAndMax(samples, numSamples);
+        return jmax(-range.getStart(), range.getEnd());
     }
 
     //==============================================================================
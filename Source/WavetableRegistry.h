@@ -0,0 +1,190 @@
+/*
+  ==============================================================================
+
+    WavetableRegistry.h
+    Created: 17 Oct 2026 9:03:48pm
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MipmappedWavetable.h"
+#include "WavetableCollector.h"
+
+
+/** One copy of each immutable wavetable, shared by every processor in the process.
+
+    Held through a SharedResourcePointer, so it is created with the first processor and freed, along with
+    every table in it, when the last one goes. Tables are keyed by Identifier: identifiers are interned,
+    so a lookup is a scan of pointer comparisons rather than string compares.
+
+    Registering is thread-safe, and a table is only ever created once per id however many instances ask
+    for it at the same time. Looking up is lock-free: entries are written once, in order, and only become
+    visible when the entry count that covers them is published.
+*/
+class WavetableRegistry
+{
+public:
+    // The most tables the registry can hold
+    static constexpr int maxTables = 256;
+
+    WavetableRegistry() = default;
+
+    //==============================================================================
+    /** Returns the table registered under id, or nullptr if there isn't one. Lock-free; not for the audio thread, as handles are reference counted.
+
+    */
+    WavetableHandle find(const Identifier& id) const
+    {
+        int index = indexOf(id, numEntries.load(std::memory_order_acquire));
+        return index >= 0 ? entries[index].table : nullptr;
+    }
+
+    /** Returns the tables registered under ids, calling create to make all of them if any are missing.
+
+        create must return one table per id, in the same order. It's called at most once across every caller
+        racing for the same ids, and ids that were already registered keep their existing table.
+    */
+    std::vector<WavetableHandle> findOrCreate(const std::vector<Identifier>& ids,
+                                              const std::function<std::vector<std::unique_ptr<MipmappedWavetable>>()>& create)
+    {
+        std::vector<WavetableHandle> found = findAll(ids);
+
+        if (std::find(found.begin(), found.end(), nullptr) == found.end())
+        {
+            return found;
+        }
+
+        const ScopedLock sl(registerLock);
+
+        // Another caller may have registered them while this one waited for the lock
+        found = findAll(ids);
+
+        if (std::find(found.begin(), found.end(), nullptr) == found.end())
+        {
+            return found;
+        }
+
+        std::vector<std::unique_ptr<MipmappedWavetable>> created = create();
+        jassert(created.size() == ids.size());
+
+        int count = numEntries.load(std::memory_order_relaxed);
+
+        for (size_t i = 0; i < ids.size() && i < created.size(); ++i)
+        {
+            if (found[i] == nullptr)
+            {
+                jassert(count < maxTables);
+
+                if (count < maxTables)
+                {
+                    found[i] = collector->adopt(std::move(created[i]));
+
+                    entries[count].id = ids[i];
+                    entries[count].table = found[i];
+                    ++count;
+                }
+            }
+        }
+
+        // Publish the new entries only once they're fully written
+        numEntries.store(count, std::memory_order_release);
+
+        return found;
+    }
+
+    /** Returns the collector the registry's tables are retired to.
+
+    */
+    WavetableCollector& getCollector() noexcept
+    {
+        return *collector;
+    }
+
+    // ==========================
+    // ====== MEMORY USAGE ======
+    // ==========================
+    struct MemoryUsage
+    {
+        int numTables = 0;
+
+        // Samples held on the heap
+        size_t ownedBytes = 0;
+
+        // Samples read from memory-mapped files, shared with any other process mapping them
+        size_t mappedBytes = 0;
+    };
+
+    /** Adds up the samples of every registered table. Lock-free.
+
+    */
+    MemoryUsage getMemoryUsage() const
+    {
+        MemoryUsage usage;
+        usage.numTables = numEntries.load(std::memory_order_acquire);
+
+        for (int i = 0; i < usage.numTables; ++i)
+        {
+            const MipmappedWavetable& table = *entries[i].table;
+
+            if (table.hasExternalStorage())
+            {
+                usage.mappedBytes += table.getSizeInBytes();
+            }
+            else
+            {
+                usage.ownedBytes += table.getSizeInBytes();
+            }
+        }
+
+        return usage;
+    }
+
+private:
+    //==============================================================================
+    struct Entry
+    {
+        Identifier id;
+        WavetableHandle table;
+    };
+
+    // Declared first, so it outlives every handle below
+    SharedResourcePointer<WavetableCollector> collector;
+
+    // Written once each, in order, under registerLock. Only the first numEntries can be read
+    Entry entries[maxTables];
+    std::atomic<int> numEntries { 0 };
+
+    CriticalSection registerLock;
+
+    int indexOf(const Identifier& id, int count) const noexcept
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            if (entries[i].id == id)
+            {
+                return i;
+            }
+        }
+
+        return -1;
+    }
+
+    std::vector<WavetableHandle> findAll(const std::vector<Identifier>& ids) const
+    {
+        std::vector<WavetableHandle> found;
+
+        for (const Identifier& id : ids)
+        {
+            found.push_back(find(id));
+        }
+
+        return found;
+    }
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WavetableRegistry)
+};
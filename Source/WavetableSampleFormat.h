@@ -0,0 +1,238 @@
+/*
+  ==============================================================================
+
+    WavetableSampleFormat.h
+    Created: 18 Oct 2026 12:26:09am
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+ #define SYNTHFRAMEWORK_SSE2 1
+ #include <emmintrin.h>
+#else
+ #define SYNTHFRAMEWORK_SSE2 0
+#endif
+
+// Set by -mavx2 or /arch:AVX2, which widen the lane renderer from four lanes to eight
+#if SYNTHFRAMEWORK_SSE2 && defined (__AVX2__)
+ #define SYNTHFRAMEWORK_AVX2 1
+ #include <immintrin.h>
+#else
+ #define SYNTHFRAMEWORK_AVX2 0
+#endif
+
+/** How the samples of a wavetable are stored.
+
+    The compact formats take half the memory and bandwidth of float32, and are decoded as they're read. Each frame
+    of each level has its own scale factor, so a frame uses the whole range of the format however loud it is.
+    The values are stored in cache files, so must never change.
+*/
+enum class WavetableSampleFormat : uint32
+{
+    // Plain floats, with no scale
+    float32 = 1,
+
+    // Signed 16 bit integers, scaled so the frame's peak is 32767
+    int16 = 2,
+
+    // IEEE 754 half precision floats, scaled so the frame's peak is 1
+    float16 = 3
+};
+
+static constexpr int numWavetableSampleFormats = 3;
+
+/** Returns the number of bytes taken by one sample in format.
+
+*/
+static constexpr int getBytesPerSample(WavetableSampleFormat format) noexcept
+{
+    return format == WavetableSampleFormat::float32 ? 4 : 2;
+}
+
+//==================================================================================
+/** Converts a float to the nearest half precision float, rounding ties to even.
+
+    Made for wavetable samples, which are never infinite or NaN: anything too large for a half becomes infinity.
+*/
+static inline uint16 floatToHalf(float value) noexcept
+{
+    uint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32 sign = (bits >> 16) & 0x8000;
+    int32 exponent = (int32)((bits >> 23) & 0xff) - 127 + 15;
+    uint32 mantissa = bits & 0x7fffff;
+
+    if (exponent >= 31)
+    {
+        return (uint16)(sign | 0x7c00);
+    }
+
+    // Too small for a normal half: shift the mantissa, implicit bit included, down into a subnormal
+    if (exponent <= 0)
+    {
+        if (exponent < -10)
+        {
+            return (uint16)sign;
+        }
+
+        mantissa |= 0x800000;
+
+        int shift = 14 - exponent;
+        uint32 half = mantissa >> shift;
+        uint32 remainder = mantissa & ((1u << shift) - 1);
+        uint32 halfway = 1u << (shift - 1);
+
+        if (remainder > halfway || (remainder == halfway && (half & 1) != 0))
+        {
+            ++half;
+        }
+
+        return (uint16)(sign | half);
+    }
+
+    uint32 half = ((uint32)exponent << 10) | (mantissa >> 13);
+    uint32 remainder = mantissa & 0x1fff;
+
+    // Rounding up may carry into the exponent, which is still the right answer
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1) != 0))
+    {
+        ++half;
+    }
+
+    return (uint16)(sign | half);
+}
+
+/** Converts a half precision float to a float. Infinities and NaNs aren't handled, as wavetables never hold them.
+
+    The exponent and mantissa are moved into place and rebiased with one multiply by 2^112, which gets subnormal halves right too.
+*/
+static inline float halfToFloat(uint16 half) noexcept
+{
+    uint32 bits = (uint32)(half & 0x7fff) << 13;
+
+    float magnitude;
+    std::memcpy(&magnitude, &bits, sizeof(magnitude));
+    magnitude *= 5.192296858534828e+33f;
+
+    return (half & 0x8000) != 0 ? -magnitude : magnitude;
+}
+
+//==================================================================================
+/** The sample type of a format, and how to read it back as floats, before its frame's scale is applied.
+
+    load4 reads one sample from each of four tables and decodes them together. Pass the same table
+    four times to read four positions of one table. With AVX2, load8 does the same for eight tables,
+    each read at its index plus offset.
+*/
+template <WavetableSampleFormat format>
+struct WavetableSampleTraits;
+
+template <>
+struct WavetableSampleTraits<WavetableSampleFormat::float32>
+{
+    using Type = float;
+
+    static forcedinline float decode(float sample) noexcept
+    {
+        return sample;
+    }
+
+   #if SYNTHFRAMEWORK_SSE2
+    static forcedinline __m128 load4(const Type* t0, const Type* t1, const Type* t2, const Type* t3,
+                                     int32 i0, int32 i1, int32 i2, int32 i3) noexcept
+    {
+        return _mm_setr_ps(t0[i0], t1[i1], t2[i2], t3[i3]);
+    }
+   #endif
+
+   #if SYNTHFRAMEWORK_AVX2
+    static forcedinline __m256 load8(const Type* const* tables, const int32* indices, int32 offset) noexcept
+    {
+        return _mm256_setr_ps(tables[0][indices[0] + offset], tables[1][indices[1] + offset],
+                              tables[2][indices[2] + offset], tables[3][indices[3] + offset],
+                              tables[4][indices[4] + offset], tables[5][indices[5] + offset],
+                              tables[6][indices[6] + offset], tables[7][indices[7] + offset]);
+    }
+   #endif
+};
+
+template <>
+struct WavetableSampleTraits<WavetableSampleFormat::int16>
+{
+    using Type = int16;
+
+    static forcedinline float decode(int16 sample) noexcept
+    {
+        return (float)sample;
+    }
+
+   #if SYNTHFRAMEWORK_SSE2
+    static forcedinline __m128 load4(const Type* t0, const Type* t1, const Type* t2, const Type* t3,
+                                     int32 i0, int32 i1, int32 i2, int32 i3) noexcept
+    {
+        // Sign extended as they're gathered, then converted in one instruction
+        return _mm_cvtepi32_ps(_mm_setr_epi32(t0[i0], t1[i1], t2[i2], t3[i3]));
+    }
+   #endif
+
+   #if SYNTHFRAMEWORK_AVX2
+    static forcedinline __m256 load8(const Type* const* tables, const int32* indices, int32 offset) noexcept
+    {
+        return _mm256_cvtepi32_ps(_mm256_setr_epi32(tables[0][indices[0] + offset], tables[1][indices[1] + offset],
+                                                    tables[2][indices[2] + offset], tables[3][indices[3] + offset],
+                                                    tables[4][indices[4] + offset], tables[5][indices[5] + offset],
+                                                    tables[6][indices[6] + offset], tables[7][indices[7] + offset]));
+    }
+   #endif
+};
+
+template <>
+struct WavetableSampleTraits<WavetableSampleFormat::float16>
+{
+    using Type = uint16;
+
+    static forcedinline float decode(uint16 sample) noexcept
+    {
+        return halfToFloat(sample);
+    }
+
+   #if SYNTHFRAMEWORK_SSE2
+    static forcedinline __m128 load4(const Type* t0, const Type* t1, const Type* t2, const Type* t3,
+                                     int32 i0, int32 i1, int32 i2, int32 i3) noexcept
+    {
+        __m128i halves = _mm_setr_epi32(t0[i0], t1[i1], t2[i2], t3[i3]);
+
+        // The same conversion as halfToFloat, four at a time with SSE2 alone. With denormals flushed,
+        // subnormal halves (below 2^-14 of the frame's peak) read as 0
+        __m128i magnitude = _mm_slli_epi32(_mm_and_si128(halves, _mm_set1_epi32(0x7fff)), 13);
+        __m128i sign = _mm_slli_epi32(_mm_and_si128(halves, _mm_set1_epi32(0x8000)), 16);
+
+        __m128 value = _mm_mul_ps(_mm_castsi128_ps(magnitude), _mm_set1_ps(5.192296858534828e+33f));
+        return _mm_or_ps(value, _mm_castsi128_ps(sign));
+    }
+   #endif
+
+   #if SYNTHFRAMEWORK_AVX2
+    static forcedinline __m256 load8(const Type* const* tables, const int32* indices, int32 offset) noexcept
+    {
+        __m256i halves = _mm256_setr_epi32(tables[0][indices[0] + offset], tables[1][indices[1] + offset],
+                                           tables[2][indices[2] + offset], tables[3][indices[3] + offset],
+                                           tables[4][indices[4] + offset], tables[5][indices[5] + offset],
+                                           tables[6][indices[6] + offset], tables[7][indices[7] + offset]);
+
+        // load4's conversion, eight wide. F16C's vcvtph2ps isn't implied by AVX2, so it isn't relied on
+        __m256i magnitude = _mm256_slli_epi32(_mm256_and_si256(halves, _mm256_set1_epi32(0x7fff)), 13);
+        __m256i sign = _mm256_slli_epi32(_mm256_and_si256(halves, _mm256_set1_epi32(0x8000)), 16);
+
+        __m256 value = _mm256_mul_ps(_mm256_castsi256_ps(magnitude), _mm256_set1_ps(5.192296858534828e+33f));
+        return _mm256_or_ps(value, _mm256_castsi256_ps(sign));
+    }
+   #endif
+};
@@ -0,0 +1,408 @@
+/*
+  ==============================================================================
+
+    WavetableSynthesiser.cpp
+    Created: 17 Oct 2026 3:41:09pm
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+
+#include "WavetableSynthesiser.h"
+#include "SynthVoice.h"
+#include "OscillatorBank.h"
+
+
+WavetableSynthesiser::WavetableSynthesiser()
+{
+}
+
+WavetableSynthesiser::~WavetableSynthesiser()
+{
+    // Workers must be stopped before the voices they render are deleted
+    renderPool.setNumWorkers(0);
+}
+
+//==================================================================================
+
+void WavetableSynthesiser::prepareToPlay(double sampleRate, int maximumBlockSize)
+{
+    setCurrentPlaybackSampleRate(sampleRate);
+
+    synthVoices.clearQuick();
+
+    // Size each voice's scratch buffers for block rendering
+    for (int i = 0; i < getNumVoices(); ++i)
+    {
+        if (SynthVoice* voice = dynamic_cast<SynthVoice*>(getVoice(i)))
+        {
+            voice->prepareToPlay(sampleRate, maximumBlockSize);
+            synthVoices.add(voice);
+        }
+    }
+
+    // Voices that are somehow still playing keep their notes
+    voiceAllocator.prepare(synthVoices.size());
+
+    for (int i = 0; i < synthVoices.size(); ++i)
+    {
+        SynthVoice* voice = synthVoices.getUnchecked(i);
+        voice->setVoiceAllocator(&voiceAllocator, i);
+
+        if (voice->isVoiceActive())
+        {
+            voiceAllocator.voiceStarted(i, voice->getCurrentlyPlayingNote());
+        }
+    }
+
+    activeVoices.ensureStorageAllocated(synthVoices.size());
+
+    mixBuffer.setSize(2, maximumBlockSize, false, false, true);
+    voiceRendered.calloc((size_t)jmax(1, synthVoices.size()));
+
+   #if SYNTHFRAMEWORK_SSE_LANES
+    int numFadeSlots = fadePool != nullptr ? fadePool->getNumSlots() : 0;
+    voiceLanes.setCapacity((synthVoices.size() + numFadeSlots) * OscillatorBank::maxOscillators);
+    laneVoices.ensureStorageAllocated(synthVoices.size());
+   #endif
+}
+
+void WavetableSynthesiser::setFadePool(FadePool* newFadePool) noexcept
+{
+    fadePool = newFadePool;
+}
+
+void WavetableSynthesiser::applyOscillatorSet(const OscillatorSet& set)
+{
+    for (SynthVoice* voice : synthVoices)
+    {
+        voice->applyOscillatorSet(set);
+    }
+
+    if (fadePool != nullptr)
+    {
+        fadePool->applyOscillatorSet(set);
+    }
+}
+
+void WavetableSynthesiser::setVoiceRenderMode(VoiceRenderMode newMode) noexcept
+{
+    renderMode.store(newMode);
+}
+
+WavetableSynthesiser::VoiceRenderMode WavetableSynthesiser::getVoiceRenderMode() const noexcept
+{
+    return renderMode.load();
+}
+
+void WavetableSynthesiser::setNumRenderThreads(int numThreads)
+{
+    renderPool.setNumWorkers(numThreads);
+}
+
+int WavetableSynthesiser::getNumRenderThreads() const noexcept
+{
+    return renderPool.getNumWorkers();
+}
+
+void WavetableSynthesiser::setVoiceStealPolicy(VoiceStealPolicy newPolicy) noexcept
+{
+    voiceAllocator.setStealPolicy(newPolicy);
+}
+
+int WavetableSynthesiser::getNumActiveVoices() const noexcept
+{
+    return voiceAllocator.getNumActiveVoices();
+}
+
+//==================================================================================
+
+SynthesiserVoice* WavetableSynthesiser::findFreeVoice(SynthesiserSound* soundToPlay, int midiChannel, int midiNoteNumber, bool stealIfNoneAvailable) const
+{
+    if (!isAllocatorReady())
+    {
+        return Synthesiser::findFreeVoice(soundToPlay, midiChannel, midiNoteNumber, stealIfNoneAvailable);
+    }
+
+    int index = voiceAllocator.findFreeVoice();
+
+    if (index < 0 && stealIfNoneAvailable)
+    {
+        index = voiceAllocator.findVoiceToSteal();
+    }
+
+    // Every voice is a SynthVoice, which can play any SynthSound
+    jassert(index < 0 || synthVoices.getUnchecked(index)->canPlaySound(soundToPlay));
+
+    return index >= 0 ? synthVoices.getUnchecked(index) : nullptr;
+}
+
+SynthesiserVoice* WavetableSynthesiser::findVoiceToSteal(SynthesiserSound* soundToPlay, int midiChannel, int midiNoteNumber) const
+{
+    if (!isAllocatorReady())
+    {
+        return Synthesiser::findVoiceToSteal(soundToPlay, midiChannel, midiNoteNumber);
+    }
+
+    int index = voiceAllocator.findVoiceToSteal();
+
+    return index >= 0 ? synthVoices.getUnchecked(index) : nullptr;
+}
+
+bool WavetableSynthesiser::isAllocatorReady() const noexcept
+{
+    return synthVoices.size() > 0 && synthVoices.size() == getNumVoices() && voiceAllocator.getNumVoices() == synthVoices.size();
+}
+
+void WavetableSynthesiser::updateVoiceAllocator() noexcept
+{
+    if (!isAllocatorReady())
+    {
+        return;
+    }
+
+    // Only the voices already known to be active are visited
+    voiceAllocator.updateActiveVoices([this] (int index)
+    {
+        SynthVoice* voice = synthVoices.getUnchecked(index);
+        return voice->isVoiceActive() ? voice->getCurrentLevel() : -1.0f;
+    });
+}
+
+void WavetableSynthesiser::gatherActiveVoices() noexcept
+{
+    activeVoices.clearQuick();
+
+    if (!isAllocatorReady())
+    {
+        for (SynthVoice* voice : synthVoices)
+        {
+            activeVoices.add(voice);
+        }
+
+        return;
+    }
+
+    voiceAllocator.forEachActiveVoice([this] (int index)
+    {
+        activeVoices.add(synthVoices.getUnchecked(index));
+    });
+}
+
+//==================================================================================
+
+void WavetableSynthesiser::renderVoices(AudioBuffer<float>& outputAudio, int startSample, int numSamples)
+{
+    VoiceRenderMode mode = renderMode.load();
+
+    // Voices started by note ons since the last call are already in the allocator
+    gatherActiveVoices();
+
+    // Shared buffers must have been sized by prepareToPlay
+    if (mixBuffer.getNumSamples() == 0)
+    {
+        Synthesiser::renderVoices(outputAudio, startSample, numSamples);
+    }
+    else if (mode == VoiceRenderMode::parallel)
+    {
+        renderParallelVoices(outputAudio, startSample, numSamples);
+    }
+   #if SYNTHFRAMEWORK_SSE_LANES
+    else if (mode == VoiceRenderMode::interleaved)
+    {
+        renderInterleavedVoices(outputAudio, startSample, numSamples);
+    }
+   #endif
+    else
+    {
+        for (SynthVoice* voice : activeVoices)
+        {
+            voice->renderNextBlock(outputAudio, startSample, numSamples);
+        }
+
+        renderSerialFades(outputAudio, startSample, numSamples);
+    }
+
+    // On the audio thread, after any render threads have finished, and before the next note on
+    updateVoiceAllocator();
+}
+
+bool WavetableSynthesiser::hasActiveFades() const noexcept
+{
+    return fadePool != nullptr && fadePool->getNumActiveFades() > 0;
+}
+
+void WavetableSynthesiser::renderSerialFades(AudioBuffer<float>& outputAudio, int startSample, int numSamples)
+{
+    int maxBlockSize = mixBuffer.getNumSamples();
+
+    // Render in chunks, in case the host passes a larger block than it promised in prepareToPlay
+    while (numSamples > 0 && hasActiveFades())
+    {
+        int numThisTime = jmin(numSamples, maxBlockSize);
+        bool stereo = outputAudio.getNumChannels() > 1 && fadePool->isPanned();
+
+        float* mixLeft = mixBuffer.getWritePointer(0);
+        float* mixRight = stereo ? mixBuffer.getWritePointer(1) : nullptr;
+
+        FloatVectorOperations::clear(mixLeft, numThisTime);
+
+        if (stereo)
+        {
+            FloatVectorOperations::clear(mixRight, numThisTime);
+        }
+
+        fadePool->renderBlock(mixLeft, mixRight, numThisTime);
+        addMixToOutput(outputAudio, startSample, numThisTime, stereo);
+
+        startSample += numThisTime;
+        numSamples -= numThisTime;
+    }
+}
+
+void WavetableSynthesiser::renderParallelVoices(AudioBuffer<float>& outputAudio, int startSample, int numSamples)
+{
+    int maxBlockSize = mixBuffer.getNumSamples();
+
+    // Render every voice in stereo if any voice needs it, so each side can be summed in one pass
+    bool stereo = false;
+
+    if (outputAudio.getNumChannels() > 1)
+    {
+        for (SynthVoice* voice : activeVoices)
+        {
+            stereo |= voice->isPanned();
+        }
+
+        stereo |= hasActiveFades() && fadePool->isPanned();
+    }
+
+    int numMixChannels = stereo ? 2 : 1;
+
+    // Render in chunks, in case the host passes a larger block than it promised in prepareToPlay
+    while (numSamples > 0)
+    {
+        int numThisTime = jmin(numSamples, maxBlockSize);
+
+        // Each voice renders into its own buffer, on whichever thread claims it
+        parallelBlockSize = numThisTime;
+        parallelStereo = stereo;
+        renderPool.run(*this, activeVoices.size());
+
+        // Sum in the order the voices were gathered, so the result doesn't depend on which thread rendered what
+        for (int channel = 0; channel < numMixChannels; ++channel)
+        {
+            float* mixSamples = mixBuffer.getWritePointer(channel);
+            FloatVectorOperations::clear(mixSamples, numThisTime);
+
+            for (int i = 0; i < activeVoices.size(); ++i)
+            {
+                if (voiceRendered[i])
+                {
+                    FloatVectorOperations::add(mixSamples, activeVoices.getUnchecked(i)->getVoiceBlock(channel), numThisTime);
+                }
+            }
+        }
+
+        // Fades are few and short, so they render on the audio thread once the voices are summed
+        if (hasActiveFades())
+        {
+            fadePool->renderBlock(mixBuffer.getWritePointer(0), stereo ? mixBuffer.getWritePointer(1) : nullptr, numThisTime);
+        }
+
+        addMixToOutput(outputAudio, startSample, numThisTime, stereo);
+
+        startSample += numThisTime;
+        numSamples -= numThisTime;
+    }
+}
+
+void WavetableSynthesiser::renderItem(int index) noexcept
+{
+    voiceRendered[index] = activeVoices.getUnchecked(index)->renderVoiceBlock(parallelBlockSize, parallelStereo);
+}
+
+#if SYNTHFRAMEWORK_SSE_LANES
+void WavetableSynthesiser::renderInterleavedVoices(AudioBuffer<float>& outputAudio, int startSample, int numSamples)
+{
+    int maxBlockSize = mixBuffer.getNumSamples();
+
+    float* mixLeft = mixBuffer.getWritePointer(0);
+    float* mixRight = mixBuffer.getWritePointer(1);
+
+    // Render in chunks, in case the host passes a larger block than it promised in prepareToPlay
+    while (numSamples > 0)
+    {
+        int numThisTime = jmin(numSamples, maxBlockSize);
+
+        // =========================
+        // ====== PACK VOICES ======
+        // =========================
+        voiceLanes.clear();
+        laneVoices.clearQuick();
+
+        for (SynthVoice* voice : activeVoices)
+        {
+            if (voice->addToLanes(voiceLanes, numThisTime))
+            {
+                laneVoices.add(voice);
+            }
+        }
+
+        bool fadesAdded = hasActiveFades();
+
+        if (fadesAdded)
+        {
+            fadePool->addToLanes(voiceLanes, numThisTime);
+        }
+
+        // ====================
+        // ====== RENDER ======
+        // ====================
+        if (!laneVoices.isEmpty() || fadesAdded)
+        {
+            // Only pay for a second channel when something is panned
+            bool stereo = outputAudio.getNumChannels() > 1 && voiceLanes.hasPannedLanes();
+
+            FloatVectorOperations::clear(mixLeft, numThisTime);
+
+            if (stereo)
+            {
+                FloatVectorOperations::clear(mixRight, numThisTime);
+                voiceLanes.renderStereo(mixLeft, mixRight, numThisTime);
+            }
+            else
+            {
+                voiceLanes.render(mixLeft, numThisTime);
+            }
+
+            addMixToOutput(outputAudio, startSample, numThisTime, stereo);
+
+            // Only after rendering, as finishing may reset the phases just written back
+            for (SynthVoice* voice : laneVoices)
+            {
+                voice->finishLanes();
+            }
+
+            if (fadesAdded)
+            {
+                fadePool->finishBlock();
+            }
+        }
+
+        startSample += numThisTime;
+        numSamples -= numThisTime;
+    }
+}
+#endif
+
+void WavetableSynthesiser::addMixToOutput(AudioBuffer<float>& outputAudio, int startSample, int numSamples, bool stereo)
+{
+    for (int channel = 0; channel < outputAudio.getNumChannels(); ++channel)
+    {
+        // Alternate sides in stereo, otherwise every channel gets the same mix
+        const float* mixSamples = mixBuffer.getReadPointer(stereo ? channel % 2 : 0);
+        FloatVectorOperations::add(outputAudio.getWritePointer(channel, startSample), mixSamples, numSamples);
+    }
+}
@@ -0,0 +1,197 @@
+/*
+  ==============================================================================
+
+    WavetableSynthesiser.h
+    Created: 17 Oct 2026 3:41:09pm
+    Author:  Sam
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Common.h"
+#include "OscillatorLanes.h"
+#include "VoiceRenderPool.h"
+#include "OscillatorSet.h"
+#include "FadePool.h"
+#include "VoiceAllocator.h"
+
+class SynthVoice;
+
+/** A Synthesiser that can render its SynthVoices together rather than one after another.
+
+    - interleaved: renderVoices packs every playing oscillator of every voice (and of any stolen note
+      fading out in the FadePool) into one set of OscillatorLanes. Four oscillators, usually from four
+      different voices, then share each SSE register, with each lane scaled by its own voice's envelope.
+
+    - parallel: voices are shared out across a VoiceRenderPool. Each voice renders into its own mono
+      buffer, and the buffers are summed in voice order, so the output is bit-identical whatever the
+      number of threads.
+
+    - serial: each voice renders and adds itself to the output in turn, as Synthesiser does.
+
+    In every mode, fades in the FadePool are rendered with the voices.
+
+    Interleaved and parallel rendering sum the voices into one mono mix, which is added to each output channel once.
+    When an oscillator is panned, the mix is rendered in stereo instead, with each lane or voice panned as it's summed.
+    Without SYNTHFRAMEWORK_SSE_LANES, interleaved rendering falls back to serial.
+
+    Voices for new notes come from a VoiceAllocator rather than a scan of every voice. Only the voices it holds
+    as active are rendered, in every mode, so idle voices cost nothing per block however high the polyphony.
+*/
+class WavetableSynthesiser : public Synthesiser,
+                             private VoiceRenderPool::Task
+{
+public:
+    enum class VoiceRenderMode
+    {
+        serial,
+        interleaved,
+        parallel
+    };
+
+    WavetableSynthesiser();
+
+    ~WavetableSynthesiser();
+
+    //==============================================================================
+    /** Sets the sample rate and sizes the voices' scratch buffers and the shared mix and lanes.
+
+        Call from prepareToPlay, after all voices have been added.
+    */
+    void prepareToPlay(double sampleRate, int maximumBlockSize);
+
+    /** Sets the pool stolen notes fade out in, which must outlive the synthesiser's rendering. Call before prepareToPlay.
+
+    */
+    void setFadePool(FadePool* newFadePool) noexcept;
+
+    /** Brings every voice's oscillators, and every fade's, in line with set.
+
+        Call from the audio thread before rendering a block, or from prepareToPlay.
+    */
+    void applyOscillatorSet(const OscillatorSet& set);
+
+    /** Sets how renderVoices renders the voices. Safe to call between blocks.
+
+    */
+    void setVoiceRenderMode(VoiceRenderMode newMode) noexcept;
+
+    VoiceRenderMode getVoiceRenderMode() const noexcept;
+
+    /** Sets the number of worker threads used by parallel rendering, in addition to the audio thread.
+
+        Starts and stops threads, so must not be called while audio is being rendered.
+    */
+    void setNumRenderThreads(int numThreads);
+
+    int getNumRenderThreads() const noexcept;
+
+    /** Sets which voice is taken when a note needs one and every voice is busy. Audio thread only.
+
+    */
+    void setVoiceStealPolicy(VoiceStealPolicy newPolicy) noexcept;
+
+    /** Returns the number of voices playing or releasing a note, as of the last block rendered. Audio thread only.
+
+    */
+    int getNumActiveVoices() const noexcept;
+
+protected:
+    //==============================================================================
+    void renderVoices(AudioBuffer<float>& outputAudio, int startSample, int numSamples) override;
+
+    SynthesiserVoice* findFreeVoice(SynthesiserSound* soundToPlay, int midiChannel, int midiNoteNumber, bool stealIfNoneAvailable) const override;
+
+    SynthesiserVoice* findVoiceToSteal(SynthesiserSound* soundToPlay, int midiChannel, int midiNoteNumber) const override;
+
+private:
+    std::atomic<VoiceRenderMode> renderMode { VoiceRenderMode::interleaved };
+
+    // Every voice as a SynthVoice, gathered by prepareToPlay so no casts or locks are needed while rendering
+    Array<SynthVoice*> synthVoices;
+
+    // The voices rendered by the current renderVoices call, gathered from the allocator
+    Array<SynthVoice*> activeVoices;
+
+    // Sum of all voices, added to every output channel. The second channel is only used when something is panned
+    AudioBuffer<float> mixBuffer;
+
+    // Where stolen notes fade out, rendered alongside the voices. Owned by the processor
+    FadePool* fadePool = nullptr;
+
+    // Which voices are free, held and released, indexed as in synthVoices. Kept up to date by the voices as notes
+    // start and are released, and by updateVoiceAllocator as they end
+    VoiceAllocator voiceAllocator;
+
+    /** Returns true once prepareToPlay has handed every voice to the allocator.
+
+    */
+    bool isAllocatorReady() const noexcept;
+
+    /** Frees voices whose notes ended in the block just rendered and refreshes every other voice's level.
+
+    */
+    void updateVoiceAllocator() noexcept;
+
+    /** Fills activeVoices with the voices that have a note to render, or with every voice until the allocator is ready.
+
+    */
+    void gatherActiveVoices() noexcept;
+
+    /** Returns true if the fade pool has any fades to render.
+
+    */
+    bool hasActiveFades() const noexcept;
+
+    /** Adds the fade pool's fades to outputAudio after Synthesiser has rendered the voices one by one.
+
+    */
+    void renderSerialFades(AudioBuffer<float>& outputAudio, int startSample, int numSamples);
+
+    // ================================
+    // ====== PARALLEL RENDERING ======
+    // ================================
+    VoiceRenderPool renderPool;
+
+    // Block size for the voices being rendered by the pool
+    int parallelBlockSize = 0;
+    bool parallelStereo = false;
+
+    // Whether each of activeVoices had anything to play in the last parallel block. Each flag is only written by the thread rendering its voice
+    HeapBlock<bool> voiceRendered;
+
+    /** Renders the active voices across renderPool in blocks of up to the size passed to prepareToPlay.
+
+    */
+    void renderParallelVoices(AudioBuffer<float>& outputAudio, int startSample, int numSamples);
+
+    // Renders a single active voice for renderPool
+    void renderItem(int index) noexcept override;
+
+   #if SYNTHFRAMEWORK_SSE_LANES
+    // ===================================
+    // ====== INTERLEAVED RENDERING ======
+    // ===================================
+    // Lanes shared by every voice and fade, with room for a full bank each
+    OscillatorLanes voiceLanes;
+
+    // Voices that added lanes to the block being rendered, and so need finishing
+    Array<SynthVoice*> laneVoices;
+
+    /** Renders the active voices through voiceLanes in blocks of up to the size passed to prepareToPlay.
+
+    */
+    void renderInterleavedVoices(AudioBuffer<float>& outputAudio, int startSample, int numSamples);
+   #endif
+
+    /** Adds numSamples of the mix to every channel of outputAudio from startSample.
+
+        In stereo, the two sides of the mix alternate across the output channels.
+    */
+    void addMixToOutput(AudioBuffer<float>& outputAudio, int startSample, int numSamples, bool stereo);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WavetableSynthesiser)
+};